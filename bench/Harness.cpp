@@ -0,0 +1,386 @@
+//
+// Harness.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Стенд для бенчмарка прошивки под simavr: грузит firmware.elf собранный в env:bench, подключает
+// заглушки SSD1306 и DS3231 к TWI, прогоняет сценарий нажатий энкодера по всем экранам и считает
+// такты между маркерами из BenchMarkers.hpp (записи в GPIOR0).
+// Запуск: bench/run.sh, результаты дописываются в bench_output.txt с хешем коммита
+
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_irq.h>
+#include <avr_ioport.h>
+#include <avr_twi.h>
+#include "BenchMarkers.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+static constexpr uint32_t kFrequency{16000000};
+static constexpr avr_io_addr_t kGpior0Address{0x3E}; // GPIOR0 в адресном пространстве данных ATmega328
+static constexpr uint8_t kSsd1306Address{0x3C};
+static constexpr uint8_t kDs3231Address{0x68};
+static constexpr uint32_t kStartTime{1640995200}; // 01.01.2022 00:00:00
+
+struct Section {
+	uint64_t startedAt;
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+};
+
+Section sections[0x80];
+avr_t *avr;
+
+// Заглушки I2C устройств
+
+struct I2cDevice {
+	uint8_t address;
+	bool selected;
+	bool pointerSet;
+	uint8_t pointer;
+	uint8_t registers[19];
+	uint32_t bytes;
+	avr_irq_t *irq;
+};
+
+I2cDevice displayDevice{kSsd1306Address, false, false, 0, {}, 0, nullptr};
+I2cDevice rtcDevice{kDs3231Address, false, false, 0, {}, 0, nullptr};
+uint32_t clockBase{kStartTime};
+uint64_t clockBaseCycle{0};
+
+uint8_t toBcd(uint32_t aValue)
+{
+	return static_cast<uint8_t>(((aValue / 10) << 4) | (aValue % 10));
+}
+
+uint32_t fromBcd(uint8_t aValue)
+{
+	return (aValue >> 4) * 10 + (aValue & 0x0F);
+}
+
+// Раскладывает unixtime в регистры времени DS3231
+void clockLatch()
+{
+	const uint32_t now = clockBase + static_cast<uint32_t>((avr->cycle - clockBaseCycle) / kFrequency);
+	time_t value = now;
+	struct tm fields;
+	gmtime_r(&value, &fields);
+
+	rtcDevice.registers[0] = toBcd(fields.tm_sec);
+	rtcDevice.registers[1] = toBcd(fields.tm_min);
+	rtcDevice.registers[2] = toBcd(fields.tm_hour);
+	rtcDevice.registers[3] = toBcd(fields.tm_wday);
+	rtcDevice.registers[4] = toBcd(fields.tm_mday);
+	rtcDevice.registers[5] = toBcd(fields.tm_mon + 1);
+	rtcDevice.registers[6] = toBcd(fields.tm_year - 100);
+}
+
+// Прошивка записала время (rtc.adjust)
+void clockStore()
+{
+	struct tm fields{};
+	fields.tm_sec = fromBcd(rtcDevice.registers[0]);
+	fields.tm_min = fromBcd(rtcDevice.registers[1]);
+	fields.tm_hour = fromBcd(rtcDevice.registers[2] & 0x3F);
+	fields.tm_mday = fromBcd(rtcDevice.registers[4]);
+	fields.tm_mon = fromBcd(rtcDevice.registers[5] & 0x1F) - 1;
+	fields.tm_year = fromBcd(rtcDevice.registers[6]) + 100;
+
+	clockBase = static_cast<uint32_t>(timegm(&fields));
+	clockBaseCycle = avr->cycle;
+}
+
+void i2cHook(avr_irq_t *, uint32_t aValue, void *aParam)
+{
+	I2cDevice *device = static_cast<I2cDevice *>(aParam);
+	avr_twi_msg_irq_t message;
+	message.u.v = aValue;
+
+	if (message.u.twi.msg & TWI_COND_STOP) {
+		if (device->selected && device == &rtcDevice && device->pointerSet && device->pointer > 0
+			&& device->pointer <= 7) {
+			clockStore();
+		}
+		device->selected = false;
+	}
+
+	if (message.u.twi.msg & TWI_COND_START) {
+		device->selected = (message.u.twi.addr >> 1) == device->address;
+		device->pointerSet = false;
+
+		if (device->selected) {
+			if ((message.u.twi.addr & 1) && device == &rtcDevice && device->pointer == 0) {
+				clockLatch();
+			}
+			avr_raise_irq(device->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, message.u.twi.addr, 1));
+		}
+	}
+
+	if (!device->selected) {
+		return;
+	}
+
+	if (message.u.twi.msg & TWI_COND_WRITE) {
+		avr_raise_irq(device->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, message.u.twi.addr, 1));
+		++device->bytes;
+
+		if (device == &rtcDevice) {
+			if (!device->pointerSet) {
+				device->pointer = message.u.twi.data % sizeof(device->registers);
+				device->pointerSet = true;
+			} else {
+				device->registers[device->pointer] = message.u.twi.data;
+				device->pointer = (device->pointer + 1) % sizeof(device->registers);
+			}
+		}
+	}
+
+	if (message.u.twi.msg & TWI_COND_READ) {
+		const uint8_t data = device->registers[device->pointer];
+		device->pointer = (device->pointer + 1) % sizeof(device->registers);
+		++device->bytes;
+		avr_raise_irq(device->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, message.u.twi.addr, data));
+	}
+}
+
+void i2cAttach(I2cDevice &aDevice)
+{
+	static const char *names[2] = {"8>i2c.out", "32<i2c.in"};
+
+	aDevice.irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+	avr_irq_register_notify(aDevice.irq + TWI_IRQ_OUTPUT, i2cHook, &aDevice);
+	avr_connect_irq(aDevice.irq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+	avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), aDevice.irq + TWI_IRQ_OUTPUT);
+}
+
+// Маркеры участков
+
+void markerHook(avr_t *aAvr, avr_io_addr_t aAddress, uint8_t aValue, void *)
+{
+	aAvr->data[aAddress] = aValue;
+	Section &section = sections[aValue & ~Bench::kBeginFlag];
+
+	if (aValue & Bench::kBeginFlag) {
+		section.startedAt = aAvr->cycle;
+	} else if (section.startedAt) {
+		const uint64_t cycles = aAvr->cycle - section.startedAt;
+		section.min = (section.count == 0 || cycles < section.min) ? cycles : section.min;
+		section.max = cycles > section.max ? cycles : section.max;
+		section.sum += cycles;
+		++section.count;
+		section.startedAt = 0;
+	}
+}
+
+// Сценарий: входы энкодера и поплавка по времени
+
+enum class Input : uint8_t {
+	KEY,
+	S1,
+	S2,
+	FLOAT,
+	SQW
+};
+
+struct Event {
+	uint32_t atMs;
+	Input input;
+	bool level;
+};
+
+void setInput(Input aInput, bool aLevel)
+{
+	switch (aInput) {
+		case Input::KEY:
+			avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 4), aLevel);
+			break;
+		case Input::S1:
+			avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 3), aLevel);
+			break;
+		case Input::S2:
+			avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 2), aLevel);
+			break;
+		case Input::FLOAT:
+			avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 0), aLevel);
+			break;
+		case Input::SQW:
+			avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 3), aLevel);
+			break;
+	}
+}
+
+Event script[256];
+size_t scriptLength{0};
+
+void add(uint32_t aAtMs, Input aInput, bool aLevel)
+{
+	if (scriptLength < sizeof(script) / sizeof(script[0])) {
+		script[scriptLength++] = Event{aAtMs, aInput, aLevel};
+	}
+}
+
+// Один щелчок энкодера: полный период квадратуры
+uint32_t addStep(uint32_t aAtMs)
+{
+	add(aAtMs, Input::S1, false);
+	add(aAtMs + 3, Input::S2, false);
+	add(aAtMs + 6, Input::S1, true);
+	add(aAtMs + 9, Input::S2, true);
+	return aAtMs + 12;
+}
+
+uint32_t addPress(uint32_t aAtMs, uint32_t aDurationMs)
+{
+	add(aAtMs, Input::KEY, false);
+	add(aAtMs + aDurationMs, Input::KEY, true);
+	return aAtMs + aDurationMs;
+}
+
+void buildScript()
+{
+	// Старт с зажатой кнопкой (firstInit) и без поплавка (экран ERROR_NOFLOATLEV)
+	add(0, Input::KEY, false);
+	add(0, Input::FLOAT, true);
+	add(500, Input::KEY, true);
+	add(2000, Input::FLOAT, false);
+
+	// Вход в настройки и проход по всем полям настроек: время, периоды света, рассвет и закат,
+	// насос, время залива, режим (шаг переключает качели на обычный, экран качелей пропускается),
+	// две точки pH и две EC
+	uint32_t at = addPress(2500, 1500) + 1000;
+	for (uint8_t i = 0; i < 28; ++i) {
+		at = addStep(at) + 500;
+		at = addPress(at, 100) + 1000;
+	}
+
+	// Выход из настроек и несколько кругов по экранам просмотра
+	at = addPress(at, 1500) + 1000;
+	for (uint8_t i = 0; i < 12; ++i) {
+		at = addStep(at) + 1000;
+	}
+}
+
+const char *sectionName(uint8_t aSection)
+{
+	static const char *displayModes[] = {"TIME", "PH_PPM", "PUMP_TIMINGS", "LAMP_TIMINGS", "STATUS",
+		"SET_CUR_TIME", "SET_LAMP_PERIOD", "SET_PUMP_TIME", "SET_SWING_PERIOD", "SET_WORKMODE",
+		"ERROR_NOFLOATLEV", "SET_MAXFLOODTIME", "SET_SUNRISE_TIME", "SET_SUNSET_TIME",
+		"SET_PH_CALIBRATION", "SET_EC_CALIBRATION", "PUMP_LOCKED"};
+	static char name[32];
+
+	switch (aSection) {
+		case Bench::kLoop:
+			return "loop";
+		case Bench::kEncoderEvents:
+			return "encoder.events";
+		case Bench::kPumpTask:
+			return "task.pump";
+		case Bench::kLampTask:
+			return "task.lamp";
+		case Bench::kIndicationTask:
+			return "task.indication";
+		default:
+			break;
+	}
+
+	const uint8_t mode = aSection - Bench::kDisplay;
+	if (aSection >= Bench::kDisplay && mode < sizeof(displayModes) / sizeof(displayModes[0])) {
+		snprintf(name, sizeof(name), "display.%s", displayModes[mode]);
+	} else {
+		snprintf(name, sizeof(name), "section.%02X", aSection);
+	}
+	return name;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s firmware.elf [tag] [seconds]\n", argv[0]);
+		return 1;
+	}
+
+	const char *tag = argc > 2 ? argv[2] : "-";
+	const uint32_t seconds = argc > 3 ? strtoul(argv[3], nullptr, 10) : 60;
+
+	elf_firmware_t firmware{};
+	if (elf_read_firmware(argv[1], &firmware)) {
+		fprintf(stderr, "Unable to load %s\n", argv[1]);
+		return 1;
+	}
+
+	avr = avr_make_mcu_by_name("atmega328p");
+	if (avr == nullptr) {
+		fprintf(stderr, "simavr has no atmega328p core\n");
+		return 1;
+	}
+
+	avr_init(avr);
+	avr_load_firmware(avr, &firmware);
+	avr->frequency = kFrequency;
+	avr->log = LOG_ERROR;
+
+	avr_register_io_write(avr, kGpior0Address, markerHook, nullptr);
+	i2cAttach(displayDevice);
+	i2cAttach(rtcDevice);
+	rtcDevice.registers[0x0E] = 0x1C; // Значения регистров управления после сброса
+
+	// Подтяжки на входах
+	setInput(Input::S1, true);
+	setInput(Input::S2, true);
+	setInput(Input::KEY, true);
+	setInput(Input::FLOAT, false);
+	setInput(Input::SQW, true);
+
+	buildScript();
+
+	const uint64_t limit = static_cast<uint64_t>(seconds) * kFrequency;
+	size_t next{0};
+	int state = cpu_Running;
+	bool sqw{true};
+
+	while (state != cpu_Done && state != cpu_Crashed && avr->cycle < limit) {
+		const uint64_t nowMs = avr->cycle / (kFrequency / 1000);
+		while (next < scriptLength && script[next].atMs <= nowMs) {
+			setInput(script[next].input, script[next].level);
+			++next;
+		}
+
+		// Меандр 1 Гц с SQW, спад на границе секунды
+		if (sqw != ((nowMs % 1000) >= 500)) {
+			sqw = !sqw;
+			setInput(Input::SQW, sqw);
+		}
+
+		state = avr_run(avr);
+	}
+
+	if (state == cpu_Crashed) {
+		fprintf(stderr, "Firmware crashed at cycle %llu\n", static_cast<unsigned long long>(avr->cycle));
+		return 1;
+	}
+
+	printf("# %s: %u s simulated, ssd1306 %u bytes, ds3231 %u bytes\n", tag, seconds, displayDevice.bytes, rtcDevice.bytes);
+	printf("# %-8s %-24s %8s %10s %10s %10s\n", "tag", "section", "count", "min", "avg", "max");
+
+	for (uint8_t i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+		const Section &section = sections[i];
+		if (section.count) {
+			printf("%-10s %-24s %8llu %10llu %10llu %10llu\n", tag, sectionName(i),
+				static_cast<unsigned long long>(section.count), static_cast<unsigned long long>(section.min),
+				static_cast<unsigned long long>(section.sum / section.count), static_cast<unsigned long long>(section.max));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Бенчмарк главного цикла под simavr без платы.
+# Собирает прошивку с маркерами (env:bench), собирает стенд и дописывает результат в bench_output.txt.
+# Перед этим собирает рабочую прошивку (env:nanoatmega328) и дописывает туда же ее предупреждения
+# компилятора и занятые Flash и RAM
+# Зависимости: platformio, simavr (libsimavr + заголовки), libelf
+# Использование: bench/run.sh [секунд симуляции]
+
+set -e
+cd "$(dirname "$0")/.."
+
+SECONDS_TO_RUN=${1:-60}
+TAG=$(git rev-parse --short HEAD 2>/dev/null || echo local)
+SIMAVR_FLAGS=$(pkg-config --cflags --libs simavr 2>/dev/null || echo "-I/usr/include/simavr -I/usr/local/include/simavr -lsimavr")
+
+mkdir -p .pio
+pio run -e nanoatmega328 > .pio/nanoatmega328.log
+grep -E 'warning:|^(RAM|Flash):' .pio/nanoatmega328.log | sed "s/^/$TAG nanoatmega328 /" | tee -a bench_output.txt
+
+pio run -e bench
+c++ -std=gnu++14 -O2 -I include bench/Harness.cpp $SIMAVR_FLAGS -lelf -o .pio/build/bench/harness
+.pio/build/bench/harness .pio/build/bench/firmware.elf "$TAG" "$SECONDS_TO_RUN" | tee -a bench_output.txt
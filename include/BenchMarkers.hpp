@@ -0,0 +1,48 @@
+//
+// BenchMarkers.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Маркеры участков кода для бенчмарка под simavr (bench/). При сборке с BENCH_MARKERS вход и выход
+// из участка пишутся в GPIOR0 одной инструкцией out, стенд ловит эти записи и считает такты.
+// Без флага маркеры ничего не делают
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(BENCH_MARKERS) && defined(__AVR__)
+#include <avr/io.h>
+#endif
+
+namespace Bench {
+
+static constexpr uint8_t kLoop{0x01};
+static constexpr uint8_t kEncoderEvents{0x02};
+static constexpr uint8_t kPumpTask{0x03};
+static constexpr uint8_t kLampTask{0x04};
+static constexpr uint8_t kIndicationTask{0x05};
+static constexpr uint8_t kDisplay{0x10}; // Плюс номер DisplayModes
+static constexpr uint8_t kBeginFlag{0x80};
+
+inline void begin(uint8_t aSection)
+{
+#if defined(BENCH_MARKERS) && defined(__AVR__)
+	GPIOR0 = aSection | kBeginFlag;
+#else
+	(void)aSection;
+#endif
+}
+
+inline void end(uint8_t aSection)
+{
+#if defined(BENCH_MARKERS) && defined(__AVR__)
+	GPIOR0 = aSection;
+#else
+	(void)aSection;
+#endif
+}
+
+} // namespace Bench
@@ -0,0 +1,46 @@
+//
+// Board.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Распиновка платы. Другой вариант платы - это другой такой же заголовок: номера выводов
+// и типы выводов, через которые их использует прошивка
+
+#pragma once
+
+#include "Pin.hpp"
+#include <stdint.h>
+
+static constexpr uint8_t kRedLedPin{5};
+static constexpr uint8_t kGreenLedPin{7};
+static constexpr uint8_t kBlueLedPin{6};
+static constexpr uint8_t kPumpPin{12};
+static constexpr uint8_t kLampPin{13};
+static constexpr uint8_t kLampDimPin{10}; // PB2, OC1B: ШИМ драйвера светодиодов от Timer1
+static constexpr uint8_t kFloatLevelPin{8}; // PB0, PCINT0
+static constexpr uint8_t kZummerPin{9};
+static constexpr uint8_t kRtcSqwPin{17}; // A3, PCINT11: выход SQW DS3231, открытый сток
+
+// Аналоговые входы датчиков, номера каналов АЦП соответствуют Hal::AdcChannel
+static constexpr uint8_t kPhProbePin{14}; // A0
+static constexpr uint8_t kEcProbePin{15}; // A1
+static constexpr uint8_t kTemperatureProbePin{16}; // A2, NTC
+
+static constexpr uint8_t kEncKeyPin{4};
+static constexpr uint8_t kEncS2Pin{2};
+static constexpr uint8_t kEncS1Pin{3};
+
+using RedLedPin = OutputPin<kRedLedPin>;
+using GreenLedPin = OutputPin<kGreenLedPin>;
+using BlueLedPin = OutputPin<kBlueLedPin>;
+using PumpPin = OutputPin<kPumpPin>;
+using LampPin = OutputPin<kLampPin>;
+using LampDimPin = OutputPin<kLampDimPin>;
+using ZummerPin = OutputPin<kZummerPin>;
+using FloatLevelPin = InputPin<kFloatLevelPin>;
+using RtcSqwPin = InputPin<kRtcSqwPin>;
+using EncKeyPin = InputPin<kEncKeyPin>;
+using EncS1Pin = InputPin<kEncS1Pin>;
+using EncS2Pin = InputPin<kEncS2Pin>;
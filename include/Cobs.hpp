@@ -0,0 +1,79 @@
+//
+// Cobs.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// COBS (Consistent Overhead Byte Stuffing): кодированные данные не содержат нулей, поэтому ноль
+// служит разделителем кадров. Приемник, подключившийся посреди потока или потерявший байт,
+// синхронизируется на следующем нуле. Накладные расходы - байт на каждые 254 байта данных
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Cobs {
+
+static constexpr uint8_t kDelimiter{0};
+
+constexpr size_t maxEncodedSize(size_t aSize)
+{
+	return aSize + aSize / 254 + 1;
+}
+
+// Кодирует aSize байт в aOut (не меньше maxEncodedSize), разделитель не дописывается.
+// Возвращает длину кодированных данных
+inline size_t encode(const uint8_t *aData, size_t aSize, uint8_t *aOut)
+{
+	size_t code = 0; // Позиция байта-счетчика текущего блока
+	size_t out = 1;
+	uint8_t distance = 1;
+
+	for (size_t i = 0; i < aSize; ++i) {
+		if (aData[i]) {
+			aOut[out++] = aData[i];
+			++distance;
+		}
+
+		if (!aData[i] || distance == 0xFF) {
+			aOut[code] = distance;
+			code = out++;
+			distance = 1;
+		}
+	}
+
+	aOut[code] = distance;
+	return out;
+}
+
+// Декодирует aSize байт без разделителя в aOut (не меньше aSize). false - данные испорчены
+inline bool decode(const uint8_t *aData, size_t aSize, uint8_t *aOut, size_t &aOutSize)
+{
+	size_t in = 0;
+	aOutSize = 0;
+
+	while (in < aSize) {
+		const uint8_t distance = aData[in++];
+		if (!distance || in + distance - 1 > aSize) {
+			return false;
+		}
+
+		for (uint8_t i = 1; i < distance; ++i) {
+			if (!aData[in]) {
+				return false;
+			}
+			aOut[aOutSize++] = aData[in++];
+		}
+
+		// Блок короче максимального заканчивается нулем, кроме последнего
+		if (distance != 0xFF && in < aSize) {
+			aOut[aOutSize++] = 0;
+		}
+	}
+
+	return true;
+}
+
+} // namespace Cobs
@@ -0,0 +1,154 @@
+//
+// ConfigStore.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Хранилище настроек в EEPROM: кольцо из Slots слотов по SlotSize байт начиная с Address.
+// Каждая запись уходит в следующий слот, так что износ распределяется по всему кольцу, а прошлая
+// запись остается целой, если питание пропадет посреди новой. В заголовке слота сигнатура,
+// номер записи, версия схемы, размер и CRC. При загрузке читаются только заголовки, берется
+// слот с наибольшим номером, и только его данные проверяются по CRC; битый слот отбрасывается
+// и берется предыдущий. Данные старой схемы короче текущей, недостающий хвост приходит
+// заполненным 0xFF, как стертая EEPROM, и дозаполняется вызывающим по версии
+
+#pragma once
+
+#include "Crc.hpp"
+#include "Hal.hpp"
+#include <stdint.h>
+#include <string.h>
+
+template<typename T, uint16_t Address, uint8_t Slots, uint8_t SlotSize>
+class ConfigStore {
+public:
+	static constexpr uint16_t kMagic{0x4859}; // "YH"
+
+	ConfigStore() :
+	_sequence{0},
+	_dataCrc{0},
+	_slot{0},
+	_version{0},
+	_valid{false}
+	{
+
+	}
+
+	// Последняя целая запись. false - целых записей нет, aData не тронута
+	bool load(T &aData, uint8_t &aVersion)
+	{
+		Header headers[Slots];
+		uint8_t candidates{0};
+
+		for (uint8_t slot = 0; slot < Slots; ++slot) {
+			Hal::eepromRead(address(slot), &headers[slot], sizeof(Header));
+			if (headers[slot].magic == kMagic && headers[slot].size <= kMaxPayload) {
+				candidates |= 1 << slot;
+			}
+		}
+
+		while (candidates) {
+			uint8_t newest{0};
+			for (uint8_t slot = 0; slot < Slots; ++slot) {
+				if ((candidates & (1 << slot)) && (!(candidates & (1 << newest))
+					|| static_cast<int16_t>(headers[slot].sequence - headers[newest].sequence) > 0)) {
+					newest = slot;
+				}
+			}
+
+			if (verify(newest, headers[newest])) {
+				memset(&aData, 0xFF, sizeof(T));
+				Hal::eepromRead(address(newest) + sizeof(Header), &aData,
+					headers[newest].size < sizeof(T) ? headers[newest].size : sizeof(T));
+
+				_slot = newest;
+				_sequence = headers[newest].sequence;
+				_version = headers[newest].version;
+				_dataCrc = Crc::ccitt(&aData, sizeof(T));
+				_valid = true;
+				aVersion = _version;
+				return true;
+			}
+			candidates &= ~(1 << newest);
+		}
+
+		return false;
+	}
+
+	// Запись в следующий слот. Если данные и версия не изменились, EEPROM не трогается.
+	// Ячейки, совпадающие с тем, что уже лежит в слоте, тоже не перезаписываются
+	void save(const T &aData, uint8_t aVersion)
+	{
+		const uint16_t dataCrc = Crc::ccitt(&aData, sizeof(T));
+		if (_valid && _version == aVersion && _dataCrc == dataCrc) {
+			return;
+		}
+
+		const uint8_t slot = _valid ? (_slot + 1) % Slots : 0;
+		Header header{kMagic, static_cast<uint16_t>(_sequence + 1), aVersion, sizeof(T), 0};
+		header.crc = Crc::ccitt(&aData, sizeof(T), metaCrc(header));
+
+		// Сначала данные, заголовок последним: пока он не записан целиком, слот не пройдет проверку
+		Hal::eepromUpdate(address(slot) + sizeof(Header), &aData, sizeof(T));
+		Hal::eepromUpdate(address(slot), &header, sizeof(Header));
+
+		_slot = slot;
+		_sequence = header.sequence;
+		_version = aVersion;
+		_dataCrc = dataCrc;
+		_valid = true;
+	}
+
+	// Номер последней записи, растет с каждым сохранением
+	uint16_t sequence() const
+	{
+		return _sequence;
+	}
+
+private:
+	struct Header {
+		uint16_t magic;
+		uint16_t sequence;
+		uint8_t version;
+		uint8_t size;
+		uint16_t crc; // По sequence, version, size и данным
+	};
+
+	static constexpr uint8_t kMaxPayload{SlotSize - sizeof(Header)};
+
+	static_assert(Slots <= 8, "Slot mask is one byte");
+	static_assert(sizeof(T) <= kMaxPayload, "Settings do not fit into a slot");
+
+	static uint16_t address(uint8_t aSlot)
+	{
+		return Address + static_cast<uint16_t>(aSlot) * SlotSize;
+	}
+
+	static uint16_t metaCrc(const Header &aHeader)
+	{
+		return Crc::ccitt(&aHeader.sequence, sizeof(aHeader.sequence) + sizeof(aHeader.version) + sizeof(aHeader.size));
+	}
+
+	// CRC считается по данным прямо из EEPROM, кусками, без копии слота в RAM
+	static bool verify(uint8_t aSlot, const Header &aHeader)
+	{
+		uint16_t crc = metaCrc(aHeader);
+		static constexpr uint8_t kChunk{8};
+		uint8_t chunk[kChunk];
+
+		for (uint8_t offset = 0; offset < aHeader.size; offset += kChunk) {
+			const uint8_t left = aHeader.size - offset;
+			const uint8_t count = left < kChunk ? left : kChunk;
+			Hal::eepromRead(address(aSlot) + sizeof(Header) + offset, chunk, count);
+			crc = Crc::ccitt(chunk, count, crc);
+		}
+		return crc == aHeader.crc;
+	}
+
+	uint16_t _sequence;
+	uint16_t _dataCrc;
+	uint8_t _slot;
+	uint8_t _version;
+	bool _valid;
+};
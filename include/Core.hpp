@@ -0,0 +1,19 @@
+//
+// Core.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Логика управления установкой, не зависит от платформы
+
+#pragma once
+
+#include <stdint.h>
+
+void coreSetup();
+void coreLoop();
+
+// Ближайший срок задач, которые переключают выходы (насос, лампа, индикация), по Hal::millis().
+// Хостовый прогон переводит часы сразу к нему: экран, датчики и телеметрия выходы не меняют
+uint32_t coreNextDeadline();
@@ -0,0 +1,46 @@
+//
+// Crc.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// CRC-16/CCITT-FALSE (полином 0x1021, начальное значение 0xFFFF) для записей в EEPROM и кадров обмена.
+// На AVR побайтовый шаг берется из avr-libc, в хостовой сборке считается так же побитно
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <util/crc16.h>
+#endif
+
+namespace Crc {
+
+static constexpr uint16_t kInitial{0xFFFF};
+
+inline uint16_t update(uint16_t aCrc, uint8_t aByte)
+{
+#ifdef __AVR__
+	return _crc_xmodem_update(aCrc, aByte);
+#else
+	aCrc ^= static_cast<uint16_t>(aByte) << 8;
+	for (uint8_t bit = 0; bit < 8; ++bit) {
+		aCrc = aCrc & 0x8000 ? (aCrc << 1) ^ 0x1021 : aCrc << 1;
+	}
+	return aCrc;
+#endif
+}
+
+inline uint16_t ccitt(const void *aData, size_t aSize, uint16_t aCrc = kInitial)
+{
+	const uint8_t *data = static_cast<const uint8_t *>(aData);
+	while (aSize--) {
+		aCrc = update(aCrc, *data++);
+	}
+	return aCrc;
+}
+
+} // namespace Crc
@@ -0,0 +1,116 @@
+//
+// Ds3231.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Регистры DS3231 и перевод их содержимого в unixtime и обратно, без обращений к шине.
+// Время в RTC локальное, годы 2000-2099, как в RTClib
+
+#pragma once
+
+#include "Flash.hpp"
+#include <stdint.h>
+
+namespace Ds3231 {
+
+static constexpr uint8_t kAddress{0x68};
+static constexpr uint8_t kTimeRegister{0x00}; // Секунды, минуты, часы, день недели, число, месяц, год
+static constexpr uint8_t kControlRegister{0x0E};
+static constexpr uint8_t kTimeSize{7};
+static constexpr uint8_t kControlSquareWave1Hz{0x00}; // INTCN = 0, RS = 00: меандр 1 Гц на SQW
+static constexpr uint32_t kSecondsFrom1970To2000{946684800UL};
+
+static const uint16_t kDaysBeforeMonth[12] PROGMEM = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+static const char kMonthNames[] PROGMEM = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+inline uint8_t fromBcd(uint8_t aValue)
+{
+	return (aValue >> 4) * 10 + (aValue & 0x0F);
+}
+
+inline uint8_t toBcd(uint8_t aValue)
+{
+	return ((aValue / 10) << 4) | (aValue % 10);
+}
+
+// Дней от 1 января 2000 до начала числа
+inline uint16_t daysFrom2000(uint8_t aYear, uint8_t aMonth, uint8_t aDay)
+{
+	uint16_t days = 365U * aYear + (aYear + 3) / 4 + pgm_read_word(&kDaysBeforeMonth[aMonth - 1]) + aDay - 1;
+	if (aMonth > 2 && aYear % 4 == 0) {
+		++days;
+	}
+	return days;
+}
+
+inline uint32_t toUnixTime(uint8_t aYear, uint8_t aMonth, uint8_t aDay, uint8_t aHour, uint8_t aMinute,
+	uint8_t aSecond)
+{
+	return kSecondsFrom1970To2000 + 86400UL * daysFrom2000(aYear, aMonth, aDay) + 3600UL * aHour
+		+ 60UL * aMinute + aSecond;
+}
+
+inline uint32_t decode(const uint8_t aRegisters[kTimeSize])
+{
+	return toUnixTime(fromBcd(aRegisters[6]), fromBcd(aRegisters[5] & 0x1F), fromBcd(aRegisters[4]),
+		fromBcd(aRegisters[2] & 0x3F), fromBcd(aRegisters[1]), fromBcd(aRegisters[0] & 0x7F));
+}
+
+inline void encode(uint32_t aUnixTime, uint8_t aRegisters[kTimeSize])
+{
+	uint32_t seconds = aUnixTime - kSecondsFrom1970To2000;
+	uint16_t days = seconds / 86400;
+	seconds %= 86400;
+
+	aRegisters[0] = toBcd(seconds % 60);
+	aRegisters[1] = toBcd((seconds / 60) % 60);
+	aRegisters[2] = toBcd(seconds / 3600); // 24-часовой формат
+	aRegisters[3] = toBcd((days + 6) % 7); // 1 января 2000 - суббота, воскресенье = 0
+
+	uint8_t year{0};
+	while (true) {
+		const uint16_t yearDays = year % 4 ? 365 : 366;
+		if (days < yearDays) {
+			break;
+		}
+		days -= yearDays;
+		++year;
+	}
+
+	uint8_t month{1};
+	while (true) {
+		uint8_t monthDays = month == 2 ? (year % 4 ? 28 : 29) : 30 + ((month + (month > 7)) & 1);
+		if (days < monthDays) {
+			break;
+		}
+		days -= monthDays;
+		++month;
+	}
+
+	aRegisters[4] = toBcd(days + 1);
+	aRegisters[5] = toBcd(month);
+	aRegisters[6] = toBcd(year);
+}
+
+// Время сборки из __DATE__ ("Oct 16 2026") и __TIME__ ("12:34:56")
+inline uint32_t parseBuildTime(const char *aDate, const char *aTime)
+{
+	uint8_t month{1};
+	for (const char *name = kMonthNames; pgm_read_byte(name); name += 3, ++month) {
+		if (pgm_read_byte(name) == aDate[0] && pgm_read_byte(name + 1) == aDate[1]
+			&& pgm_read_byte(name + 2) == aDate[2]) {
+			break;
+		}
+	}
+
+	const auto number = [](const char *aText) -> uint8_t {
+		return (aText[0] == ' ' ? 0 : (aText[0] - '0') * 10) + (aText[1] - '0');
+	};
+
+	return toUnixTime(number(aDate + 9), month, number(aDate + 4), number(aTime), number(aTime + 3),
+		number(aTime + 6));
+}
+
+} // namespace Ds3231
@@ -0,0 +1,160 @@
+//
+// EventLog.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Журнал событий в EEPROM: кольцо записей по 4 байта - тип, аргумент и секунды от предыдущей записи.
+// Полное время пишется служебной записью kClock, когда разница не помещается в 16 бит, время пошло
+// назад (перевод часов, первая запись после старта) или прошло kClockInterval записей, чтобы после
+// затирания кругом время восстанавливалось почти для всего журнала. Старший бит типа - номер круга:
+// при каждом проходе кольца он меняется, поэтому голова находится двоичным поиском по первым байтам.
+// Первый байт записи пишется последним, недописанная запись остается записью прошлого круга
+
+#pragma once
+
+#include "Hal.hpp"
+#include <stdint.h>
+
+template<uint16_t Address, uint16_t Size>
+class EventLog {
+public:
+	static constexpr uint8_t kClock{0x7E};
+	static constexpr uint8_t kEmpty{0x7F}; // Стертая EEPROM
+	static constexpr uint16_t kCapacity{Size / 4};
+	static constexpr uint8_t kClockInterval{16};
+
+	struct Entry {
+		uint8_t type;
+		uint8_t argument;
+		uint32_t time;
+		bool timeKnown; // Запись с полным временем до этой уже затерта кругом
+	};
+
+	// Чтение от самой старой записи к самой новой
+	struct Cursor {
+		uint16_t index;
+		uint16_t left;
+		uint32_t time;
+		bool timeKnown;
+	};
+
+	EventLog() :
+	_lastTime{0},
+	_head{0},
+	_sinceClock{0},
+	_lap{false},
+	_anchored{false}
+	{
+
+	}
+
+	// Поиск головы: записи до нее принадлежат текущему кругу, с нее - прошлому
+	void begin()
+	{
+		const bool firstLap = lap(0);
+		uint16_t low{1};
+		uint16_t high{kCapacity};
+
+		while (low < high) {
+			const uint16_t middle = (low + high) / 2;
+			if (lap(middle) == firstLap) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+
+		if (low == kCapacity) {
+			// Круг заполнен целиком, следующий начнется с нуля
+			_head = 0;
+			_lap = !firstLap;
+		} else {
+			_head = low;
+			_lap = firstLap;
+		}
+		_anchored = false;
+	}
+
+	// O(1): одна запись, перед ней при необходимости запись полного времени
+	void append(uint8_t aType, uint8_t aArgument, uint32_t aTime)
+	{
+		if (!_anchored || aTime - _lastTime > UINT16_MAX || _sinceClock >= kClockInterval) {
+			const uint32_t base = aTime & ~0xFFUL;
+			write(kClock, static_cast<uint8_t>(aTime >> 24), static_cast<uint16_t>(aTime >> 8));
+			_lastTime = base;
+			_sinceClock = 0;
+			_anchored = true;
+		}
+
+		write(aType, aArgument, static_cast<uint16_t>(aTime - _lastTime));
+		_lastTime = aTime;
+		++_sinceClock;
+	}
+
+	void rewind(Cursor &aCursor) const
+	{
+		aCursor = Cursor{_head, kCapacity, 0, false};
+	}
+
+	// Следующая событийная запись, служебные и пустые пропускаются
+	bool next(Cursor &aCursor, Entry &aEntry) const
+	{
+		while (aCursor.left) {
+			uint8_t record[4];
+			Hal::eepromRead(address(aCursor.index), record, sizeof(record));
+			aCursor.index = aCursor.index + 1 < kCapacity ? aCursor.index + 1 : 0;
+			--aCursor.left;
+
+			const uint8_t type = record[0] & 0x7F;
+			const uint16_t delta = record[2] | (record[3] << 8);
+
+			if (type == kEmpty) {
+				continue;
+			} else if (type == kClock) {
+				aCursor.time = (static_cast<uint32_t>(record[1]) << 24) | (static_cast<uint32_t>(delta) << 8);
+				aCursor.timeKnown = true;
+				continue;
+			}
+
+			aCursor.time += delta;
+			aEntry = Entry{type, record[1], aCursor.time, aCursor.timeKnown};
+			return true;
+		}
+		return false;
+	}
+
+private:
+	static uint16_t address(uint16_t aIndex)
+	{
+		return Address + aIndex * 4;
+	}
+
+	static bool lap(uint16_t aIndex)
+	{
+		uint8_t first;
+		Hal::eepromRead(address(aIndex), &first, sizeof(first));
+		return first & 0x80;
+	}
+
+	void write(uint8_t aType, uint8_t aArgument, uint16_t aDelta)
+	{
+		const uint8_t tail[3] = {aArgument, static_cast<uint8_t>(aDelta), static_cast<uint8_t>(aDelta >> 8)};
+		const uint8_t first = (_lap ? 0x80 : 0) | aType;
+
+		Hal::eepromUpdate(address(_head) + 1, tail, sizeof(tail));
+		Hal::eepromUpdate(address(_head), &first, sizeof(first));
+
+		if (++_head == kCapacity) {
+			_head = 0;
+			_lap = !_lap;
+		}
+	}
+
+	uint32_t _lastTime;
+	uint16_t _head;
+	uint8_t _sinceClock;
+	bool _lap;
+	bool _anchored;
+};
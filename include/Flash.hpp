@@ -0,0 +1,24 @@
+//
+// Flash.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Доступ к константам во flash. На AVR это pgmspace, в хостовой сборке обычная память
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(aText) (aText)
+#define pgm_read_byte(aAddress) (*reinterpret_cast<const uint8_t *>(aAddress))
+#define pgm_read_word(aAddress) (*reinterpret_cast<const uint16_t *>(aAddress))
+#define memcpy_P memcpy
+#endif
@@ -0,0 +1,142 @@
+//
+// Hal.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Тонкий слой абстракции над железом. Логика управления (Core.cpp) работает только через него,
+// реализации лежат в src/avr (Arduino Nano) и src/native (фейки в памяти для сборки на Linux)
+
+#pragma once
+
+#include "PinMap.hpp"
+#include "RotaryEncoder.hpp"
+#include "Telemetry.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hal {
+
+enum class PinMode : uint8_t {
+	OUT,
+	IN,
+	IN_PULLUP
+};
+
+// GPIO для хостовой сборки. На AVR прошивка работает с выводами через Pin.hpp напрямую
+void gpioMode(uint8_t aPin, PinMode aMode);
+void gpioWrite(uint8_t aPin, bool aState);
+bool gpioRead(uint8_t aPin);
+void portWrite(Port aPort, uint8_t aMask, uint8_t aValue); // Биты aMask порта получают значения из aValue
+
+// Часы микроконтроллера
+uint32_t millis();
+uint32_t micros();
+
+// Тики свободно бегущего аппаратного таймера для замеров длительности: дешевле micros() и без
+// умножения. На AVR это Timer0 Arduino с делителем 64
+static constexpr uint8_t kTickMicros{4};
+uint32_t ticks();
+
+// RTC, время хранится как unixtime локального времени (как в RTClib). Чтение идет в фоне
+enum class RtcStatus : uint8_t {
+	BUSY,
+	DONE,
+	FAILED // Ошибка шины или секундная метка пришла во время чтения
+};
+
+void rtcInit();
+bool rtcRequest(); // Запускает чтение времени, false если очередь шины занята
+RtcStatus rtcResult(uint32_t &aUnixTime, uint32_t &aTicks); // aTicks - секундная метка, к которой относится время
+void rtcWrite(uint32_t aUnixTime);
+uint32_t buildTime(); // Время компиляции прошивки
+void rtcTickInit(); // Секундные метки с выхода SQW по прерыванию
+uint32_t rtcTicks(); // Число секундных меток с момента инициализации
+
+// Поплавок камеры, true - камера полна. Фронты ловятся прерыванием по изменению уровня, новый уровень
+// принимается после aDebounceTime миллисекунд покоя, выдержку отсчитывает аппаратный таймер.
+// Принятые изменения копятся в очереди для главного цикла. Взведенная отсечка выключает насос
+// прямо из прерывания, как только принят уровень "полна", и после этого снимается
+void floatInit(uint8_t aDebounceTime);
+bool floatLevel(); // Последний принятый уровень
+bool floatEvent(bool &aLevel); // Следующее изменение из очереди, false если очередь пуста
+void floatCutoff(bool aArmed);
+
+// Энкодер, декодируется в прерывании, события копятся в очереди
+void encoderInit();
+bool encoderEvent(EncoderEvent &aEvent); // Следующее событие, false если накопленного больше нет
+
+// ШИМ лампы на аппаратном таймере, aDuty от 0 (вывод выключен) до LampDimmer::kPwmTop.
+// Скважность держит таймер, главный цикл меняет только регистр сравнения
+void lampPwmInit();
+void lampPwm(uint16_t aDuty);
+
+// АЦП датчиков раствора. Преобразования идут непрерывно по прерыванию, каналы по кругу.
+// kAdcOversampling отсчетов канала складываются и делятся так, что значение получает kAdcBits бит
+// (передискретизация, шум АЦП работает как подмес). Готовые значения копятся в очереди
+enum class AdcChannel : uint8_t {
+	PH,
+	EC,
+	TEMPERATURE,
+	COUNT
+};
+
+struct AdcSample {
+	AdcChannel channel;
+	uint16_t value;
+};
+
+static constexpr uint8_t kAdcBits{14};
+static constexpr uint16_t kAdcOversampling{256}; // 4 в степени (kAdcBits - 10)
+
+void adcInit();
+bool adcSample(AdcSample &aSample); // Следующее значение, false если очередь пуста
+
+// EEPROM
+void eepromRead(uint16_t aAddress, void *aData, size_t aSize);
+void eepromUpdate(uint16_t aAddress, const void *aData, size_t aSize);
+
+// Экран
+void displayInit();
+void displayClear();
+void displayPrint(uint8_t aX, uint8_t aY, const char *aText);
+void displayFlush(); // Запускает отправку, страницы уходят в фоне
+void displayRefresh(); // Следующий displayFlush() повторит настройку экрана и все страницы, а не только изменившиеся
+void displayService(); // Досылает страницы, вызывается в каждом проходе цикла
+bool displayBusy(); // Предыдущий кадр еще передается
+
+// Порт телеметрии. Все, что уходит в порт, - кадры Telemetry, отладочные строки идут кадрами TEXT.
+// Передача идет в фоне, кадр, не поместившийся в буфер передачи целиком, отбрасывается и считается
+void telemetryInit();
+bool telemetry(Telemetry::Type aType, const void *aPayload, uint8_t aSize); // false - кадр отброшен
+uint16_t telemetryDropped(); // Отброшенных кадров с запуска
+void log(const char *aText);
+bool logRead(char &aChar); // Следующий принятый символ (команды с той же линии), false если ничего не пришло
+
+// ОЗУ. На плате память между статическими данными и стеком при запуске заполняется меткой,
+// memoryStatus() ищет нетронутые байты над кучей, проход занимает доли миллисекунды
+struct MemoryStatus {
+	uint16_t stackFree; // Наименьший запас между кучей и стеком с запуска, байты
+	uint16_t free; // Запас сейчас: от вершины кучи до указателя стека
+	uint16_t heapTop; // Адрес конца кучи, при пустой куче - ее начала
+	uint16_t heapFree; // Байты в освобожденных блоках внутри кучи - фрагментация
+};
+
+void memoryStatus(MemoryStatus &aStatus);
+
+// Сторож. Если главный цикл не сбрасывает его дольше периода (0.5 с на плате), насос выключается
+// из прерывания, еще через период плата перезапускается. Причина сброса сохраняется до main()
+enum class ResetCause : uint8_t {
+	UNKNOWN,
+	POWER_ON,
+	EXTERNAL, // Кнопка сброса или программатор
+	BROWN_OUT,
+	WATCHDOG
+};
+
+void watchdogInit();
+void watchdogReset(); // В каждом проходе главного цикла
+ResetCause resetCause(); // Причина последнего запуска
+
+} // namespace Hal
@@ -0,0 +1,38 @@
+//
+// Hash.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// FNV-1a, 32 бита. Используется как дешевый ключ содержимого (экран, страницы видеобуфера)
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+static constexpr uint32_t kFnvOffset{2166136261UL};
+static constexpr uint32_t kFnvPrime{16777619UL};
+
+inline uint32_t fnv1a(const void *aData, size_t aSize, uint32_t aHash = kFnvOffset)
+{
+	const uint8_t *data = static_cast<const uint8_t *>(aData);
+	while (aSize--) {
+		aHash = (aHash ^ *data++) * kFnvPrime;
+	}
+	return aHash;
+}
+
+// Строка вместе с завершающим нулем, чтобы "ab" + "c" и "a" + "bc" давали разные ключи
+inline uint32_t fnv1a(const char *aText, uint32_t aHash = kFnvOffset)
+{
+	do {
+		aHash = (aHash ^ static_cast<uint8_t>(*aText)) * kFnvPrime;
+	} while (*aText++);
+	return aHash;
+}
+
+} // namespace Hash
@@ -0,0 +1,91 @@
+//
+// LampDimmer.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Яркость лампы с плавным рассветом и закатом. Уровень 0..255 растет линейно от начала периода
+// света и спадает к его концу, в скважность ШИМ он переводится по таблице гаммы во flash.
+// Для каждого уровня известен момент следующего шага, поэтому задача лампы просыпается
+// только тогда, когда регистр сравнения действительно нужно поменять
+
+#pragma once
+
+#include "Flash.hpp"
+#include <stdint.h>
+
+namespace LampDimmer {
+
+static constexpr uint16_t kPwmTop{1023}; // 10 бит, TOP таймера ШИМ
+static constexpr uint8_t kMaxLevel{255};
+
+// round(1023 * (level / 255) ^ 2.2), ненулевой уровень дает хотя бы единицу скважности
+static const uint16_t kGamma[kMaxLevel + 1] PROGMEM = {
+	   0,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    2,    2,
+	   2,    3,    3,    3,    4,    4,    5,    5,    6,    6,    7,    7,    8,    9,    9,   10,
+	  11,   11,   12,   13,   14,   15,   16,   16,   17,   18,   19,   20,   21,   23,   24,   25,
+	  26,   27,   28,   30,   31,   32,   34,   35,   36,   38,   39,   41,   42,   44,   46,   47,
+	  49,   51,   52,   54,   56,   58,   60,   61,   63,   65,   67,   69,   71,   73,   76,   78,
+	  80,   82,   84,   87,   89,   91,   94,   96,   98,  101,  103,  106,  109,  111,  114,  117,
+	 119,  122,  125,  128,  130,  133,  136,  139,  142,  145,  148,  151,  155,  158,  161,  164,
+	 167,  171,  174,  177,  181,  184,  188,  191,  195,  198,  202,  206,  209,  213,  217,  221,
+	 225,  228,  232,  236,  240,  244,  248,  252,  257,  261,  265,  269,  274,  278,  282,  287,
+	 291,  295,  300,  304,  309,  314,  318,  323,  328,  333,  337,  342,  347,  352,  357,  362,
+	 367,  372,  377,  382,  387,  393,  398,  403,  408,  414,  419,  425,  430,  436,  441,  447,
+	 452,  458,  464,  470,  475,  481,  487,  493,  499,  505,  511,  517,  523,  529,  535,  542,
+	 548,  554,  561,  567,  573,  580,  586,  593,  599,  606,  613,  619,  626,  633,  640,  647,
+	 653,  660,  667,  674,  681,  689,  696,  703,  710,  717,  725,  732,  739,  747,  754,  762,
+	 769,  777,  784,  792,  800,  807,  815,  823,  831,  839,  847,  855,  863,  871,  879,  887,
+	 895,  903,  912,  920,  928,  937,  945,  954,  962,  971,  979,  988,  997, 1005, 1014, 1023
+};
+
+struct Step {
+	uint8_t level;
+	uint32_t next; // Момент, в который уровень изменится
+};
+
+inline uint16_t duty(uint8_t aLevel)
+{
+	return pgm_read_word(&kGamma[aLevel]);
+}
+
+// Уровень через aElapsed секунд от начала рампы длиной aRamp секунд, без рампы - сразу полный
+inline uint8_t rampLevel(uint32_t aElapsed, uint16_t aRamp)
+{
+	return aElapsed >= aRamp ? kMaxLevel : static_cast<uint8_t>(aElapsed * kMaxLevel / aRamp);
+}
+
+// Секунд от начала рампы, за которые набирается уровень aLevel
+inline uint32_t rampTime(uint8_t aLevel, uint16_t aRamp)
+{
+	return (static_cast<uint32_t>(aLevel) * aRamp + kMaxLevel - 1) / kMaxLevel;
+}
+
+// Яркость в момент aNow. aLastChange и aNextChange - переключения расписания вокруг aNow,
+// рассвет идет от включения, закат заканчивается в момент выключения
+inline Step step(uint32_t aNow, bool aState, uint32_t aLastChange, uint32_t aNextChange, uint16_t aSunrise,
+	uint16_t aSunset)
+{
+	if (!aState) {
+		return Step{0, aNextChange};
+	}
+
+	const uint8_t up = rampLevel(aNow - aLastChange, aSunrise);
+	const uint8_t down = rampLevel(aNextChange - aNow, aSunset);
+	uint32_t next = aNextChange;
+
+	if (up < kMaxLevel) {
+		const uint32_t upNext = aLastChange + rampTime(up + 1, aSunrise);
+		next = static_cast<int32_t>(upNext - next) < 0 ? upNext : next;
+	}
+	if (down) {
+		// Уровень заката опустится ниже down, когда до выключения останется меньше rampTime(down)
+		const uint32_t downNext = aNextChange - rampTime(down, aSunset) + 1;
+		next = static_cast<int32_t>(downNext - next) < 0 ? downNext : next;
+	}
+
+	return Step{up < down ? up : down, next};
+}
+
+} // namespace LampDimmer
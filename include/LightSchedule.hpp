@@ -0,0 +1,189 @@
+//
+// LightSchedule.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Расписание света из нескольких периодов за сутки. Периоды сводятся в отсортированную таблицу
+// переключений: время суток и состояние после него, соседние записи всегда отличаются состоянием.
+// Текущее состояние ищется двоичным поиском, момент следующего переключения запоминается,
+// и до него состояние отдается без поиска
+
+#pragma once
+
+#include "TimeContainer.hpp"
+#include <stdint.h>
+
+struct LightPeriod {
+	TimeContainer on;
+	TimeContainer off; // Совпадает с on - период выключен
+};
+
+template<uint8_t Periods>
+class LightSchedule {
+public:
+	static constexpr uint8_t kMaxEvents{Periods * 2};
+
+	LightSchedule() :
+	_events{},
+	_count{0},
+	_cacheFrom{0},
+	_cacheUntil{0},
+	_lastChange{0},
+	_state{false}
+	{
+
+	}
+
+	// Пересобирает таблицу, пересекающиеся периоды объединяются
+	void build(const LightPeriod (&aPeriods)[Periods])
+	{
+		uint32_t times[kMaxEvents];
+		uint8_t timesCount{0};
+
+		for (uint8_t i = 0; i < Periods; ++i) {
+			if (aPeriods[i].on != aPeriods[i].off) {
+				insertUnique(times, timesCount, aPeriods[i].on.secondsOfDay());
+				insertUnique(times, timesCount, aPeriods[i].off.secondsOfDay());
+			}
+		}
+
+		_count = 0;
+		for (uint8_t i = 0; i < timesCount; ++i) {
+			const TimeContainer time = TimeContainer::fromSeconds(times[i]);
+			bool state{false};
+
+			for (uint8_t j = 0; j < Periods; ++j) {
+				state = state || TimeWindow{aPeriods[j].on, aPeriods[j].off}.contains(time);
+			}
+			_events[_count++] = pack(times[i], state);
+		}
+
+		// Переключения, не меняющие состояние, выкидываются. Таблица циклична, последняя запись
+		// действует и после полуночи, поэтому первую сравниваем с последней
+		uint8_t kept{0};
+		for (uint8_t i = 0; i < _count; ++i) {
+			const uint32_t previous = kept ? _events[kept - 1] : _events[_count - 1];
+			if (!kept || stateOf(previous) != stateOf(_events[i])) {
+				_events[kept++] = _events[i];
+			}
+		}
+		if (kept > 1 && stateOf(_events[0]) == stateOf(_events[kept - 1])) {
+			// Первая запись повторяет состояние, перешедшее через полночь
+			for (uint8_t i = 1; i < kept; ++i) {
+				_events[i - 1] = _events[i];
+			}
+			--kept;
+		}
+		_count = kept;
+
+		invalidate();
+	}
+
+	// Состояние на момент aUnixTime
+	bool state(uint32_t aUnixTime)
+	{
+		if (aUnixTime - _cacheFrom >= _cacheUntil - _cacheFrom) {
+			lookup(aUnixTime);
+		}
+		return _state;
+	}
+
+	// Момент следующего переключения после последнего вызова state()
+	uint32_t nextChange() const
+	{
+		return _cacheUntil;
+	}
+
+	// Момент переключения, с которого действует текущее состояние. Смысл имеет только при events() > 1
+	uint32_t lastChange() const
+	{
+		return _lastChange;
+	}
+
+	// Время, настройки или таблица изменились, следующий state() сделает поиск заново
+	void invalidate()
+	{
+		_cacheFrom = 0;
+		_cacheUntil = 0;
+	}
+
+	uint8_t events() const
+	{
+		return _count;
+	}
+
+private:
+	static uint32_t pack(uint32_t aSeconds, bool aState)
+	{
+		return (aSeconds << 1) | aState;
+	}
+
+	static uint32_t secondsOf(uint32_t aEvent)
+	{
+		return aEvent >> 1;
+	}
+
+	static bool stateOf(uint32_t aEvent)
+	{
+		return aEvent & 1;
+	}
+
+	static void insertUnique(uint32_t *aTimes, uint8_t &aCount, uint32_t aTime)
+	{
+		uint8_t position = aCount;
+		while (position && aTimes[position - 1] > aTime) {
+			--position;
+		}
+		if (position && aTimes[position - 1] == aTime) {
+			return;
+		}
+		for (uint8_t i = aCount; i > position; --i) {
+			aTimes[i] = aTimes[i - 1];
+		}
+		aTimes[position] = aTime;
+		++aCount;
+	}
+
+	void lookup(uint32_t aUnixTime)
+	{
+		const uint32_t daySeconds = TimeContainer::fromSeconds(aUnixTime).secondsOfDay();
+		const uint32_t dayStart = aUnixTime - daySeconds;
+
+		if (!_count) {
+			_state = false;
+			_cacheFrom = aUnixTime;
+			_cacheUntil = dayStart + TimeContainer::kSecondsInDay;
+			_lastChange = dayStart;
+			return;
+		}
+
+		// Первая запись, время которой больше текущего
+		uint8_t low{0};
+		uint8_t high{_count};
+		while (low < high) {
+			const uint8_t middle = (low + high) / 2;
+			if (secondsOf(_events[middle]) <= daySeconds) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+
+		// До первой записи суток действует последняя запись прошлых суток
+		_state = stateOf(_events[low ? low - 1 : _count - 1]);
+		_cacheFrom = aUnixTime;
+		_cacheUntil = low < _count ? dayStart + secondsOf(_events[low])
+			: dayStart + TimeContainer::kSecondsInDay + secondsOf(_events[0]);
+		_lastChange = low ? dayStart + secondsOf(_events[low - 1])
+			: dayStart - TimeContainer::kSecondsInDay + secondsOf(_events[_count - 1]);
+	}
+
+	uint32_t _events[kMaxEvents]; // Секунды суток << 1 | состояние после переключения
+	uint8_t _count;
+	uint32_t _cacheFrom;
+	uint32_t _cacheUntil;
+	uint32_t _lastChange;
+	bool _state;
+};
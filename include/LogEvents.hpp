@@ -0,0 +1,38 @@
+//
+// LogEvents.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// События установки. Номера хранятся в журнале EEPROM и передаются в кадрах телеметрии,
+// поэтому не должны меняться, новые добавляются в конец
+
+#pragma once
+
+#include "Flash.hpp"
+#include <stdint.h>
+
+enum class LogEvents : uint8_t {
+	BOOT, // Аргумент - причина сброса (Hal::ResetCause)
+	PUMP_ON, // Аргумент - режим
+	PUMP_OFF, // Аргумент - сколько раз за залив камера заполнилась
+	FLOAT_TIMEOUT, // Аргумент - режим
+	FLOAT_MISSING,
+	ERROR, // Аргумент - тип ошибки
+	SWING_ON, // Только телеметрия, в журнал качели не пишутся, чтобы не изнашивать EEPROM
+	SWING_OFF, // Только телеметрия. Аргумент - сколько раз за залив камера заполнилась
+	STACK_LOW, // Аргумент - наименьший запас ОЗУ между кучей и стеком, байты (не больше 255)
+	PUMP_LOCKED, // Критическая ошибка, насос не включится до сброса с экрана
+	PUMP_UNLOCKED,
+	RTC_FAILED, // RTC не ответил при синхронном чтении, время идет по millis
+	SWING_SKIP, // Только телеметрия. Интервал качелей кончился, а камера еще полна, насос не включен
+	COUNT
+};
+
+static const char kLogEventNames[][14] PROGMEM = {"boot", "pump on", "pump off", "float timeout", "float missing",
+	"error", "swing on", "swing off", "stack low", "pump locked", "pump unlocked",
+	"rtc failed", "swing skip"};
+
+static_assert(sizeof(kLogEventNames) / sizeof(kLogEventNames[0]) == static_cast<uint8_t>(LogEvents::COUNT),
+	"Every event needs a name");
@@ -0,0 +1,151 @@
+//
+// Menu.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Описание экранов меню таблицами во flash. Экран - заголовок, соседние экраны для просмотра,
+// настраиваемые поля и необязательные обработчики для того, что таблицей не описать. Поле -
+// указатель на значение, пределы, шаг и формат вывода. Навигация, настройка и вывод общие для
+// всех экранов, переход на другой экран - чтение одной записи таблицы по номеру
+
+#pragma once
+
+#include "Flash.hpp"
+#include "TextBuffer.hpp"
+#include <stdint.h>
+
+namespace Menu {
+
+static constexpr uint8_t kLineLength{21}; // Символов в строке экрана 128x32 шрифтом 6x8
+static constexpr uint8_t kNone{UINT8_MAX}; // Нет экрана
+
+using Line = TextBuffer<kLineLength>;
+
+enum class ValueType : uint8_t {
+	U8,
+	U16,
+	I16
+};
+
+enum class Format : uint8_t {
+	NUMBER,
+	TWO_DIGITS, // С ведущим нулем, для часов и минут
+	FIXED2, // Сотые: 652 - "6.52"
+	HIDDEN // Значение выводит обработчик экрана
+};
+
+struct Field {
+	void *value;
+	ValueType type;
+	Format format;
+	int16_t min;
+	int16_t max;
+	uint8_t step; // Шаг за щелчок, ускорение энкодера умножает его
+	const char *label; // Текст во flash перед значением или nullptr
+};
+
+struct Screen {
+	const char *title; // Первая строка во flash или nullptr
+	uint8_t left; // Соседние экраны при просмотре
+	uint8_t right;
+	uint8_t next; // Экран после последнего поля, если нет leave
+	uint8_t firstField; // Номер первого поля в таблице полей
+	uint8_t fieldCount;
+	uint8_t x; // Отступ второй строки в точках
+	void (*load)(); // Перед настройкой и выводом: скопировать значения в поля
+	void (*changed)(); // После настройки: применить значения полей
+	uint8_t (*leave)(); // После последнего поля: номер следующего экрана
+	void (*render)(Line &aLine1, Line &aLine2); // Дописать то, что не описано полями
+};
+
+// Копия записи таблицы из flash
+template<typename T>
+T read(const T *aEntry)
+{
+	T entry;
+	memcpy_P(&entry, aEntry, sizeof(T));
+	return entry;
+}
+
+inline int16_t get(const Field &aField)
+{
+	switch (aField.type) {
+		case ValueType::U8:
+			return *static_cast<const uint8_t *>(aField.value);
+		case ValueType::U16:
+			return static_cast<int16_t>(*static_cast<const uint16_t *>(aField.value));
+		case ValueType::I16:
+			return *static_cast<const int16_t *>(aField.value);
+	}
+	return 0;
+}
+
+inline void set(const Field &aField, int16_t aValue)
+{
+	switch (aField.type) {
+		case ValueType::U8:
+			*static_cast<uint8_t *>(aField.value) = static_cast<uint8_t>(aValue);
+			break;
+		case ValueType::U16:
+			*static_cast<uint16_t *>(aField.value) = static_cast<uint16_t>(aValue);
+			break;
+		case ValueType::I16:
+			*static_cast<int16_t *>(aField.value) = aValue;
+			break;
+	}
+}
+
+// Увеличение с переходом на aMin после aMax, при ускорении значение сначала упирается в aMax
+inline int16_t stepUp(int16_t aValue, uint16_t aStep, int16_t aMin, int16_t aMax)
+{
+	if (aValue >= aMax) {
+		return aMin;
+	}
+	return static_cast<int32_t>(aMax) - aValue > aStep ? aValue + aStep : aMax;
+}
+
+inline int16_t stepDown(int16_t aValue, uint16_t aStep, int16_t aMin, int16_t aMax)
+{
+	if (aValue <= aMin) {
+		return aMax;
+	}
+	return static_cast<int32_t>(aValue) - aMin > aStep ? aValue - aStep : aMin;
+}
+
+// Одно поле: подпись и значение, активное при нескольких полях в скобках
+inline void render(const Field &aField, bool aActive, Line &aLine)
+{
+	if (aField.label) {
+		aLine.appendP(aField.label);
+	}
+	if (aField.format == Format::HIDDEN) {
+		return;
+	}
+
+	if (aActive) {
+		aLine.append('[');
+	}
+
+	const int16_t value = get(aField);
+	switch (aField.format) {
+		case Format::NUMBER:
+			aLine.appendFixed(value, 0);
+			break;
+		case Format::TWO_DIGITS:
+			aLine.appendTwoDigits(static_cast<uint8_t>(value));
+			break;
+		case Format::FIXED2:
+			aLine.appendFixed(value, 2);
+			break;
+		case Format::HIDDEN:
+			break;
+	}
+
+	if (aActive) {
+		aLine.append(']');
+	}
+}
+
+} // namespace Menu
@@ -0,0 +1,126 @@
+//
+// OutputBank.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Набор выходов с теневым состоянием. set() меняет только тень, commit() раз за проход цикла
+// пишет изменившиеся каналы одной маскированной записью на порт и не трогает порт, если ничего
+// не поменялось. Каналы задаются типами OutputPin, порт и бит каждого известны при компиляции.
+// Заодно считаются реальные переключения каждого канала
+
+#pragma once
+
+#include "Pin.hpp"
+#include <stdint.h>
+
+template<typename... Pins>
+class OutputBank {
+public:
+	static constexpr uint8_t kCount{sizeof...(Pins)};
+	static_assert(kCount <= 8, "Shadow holds up to 8 channels");
+
+	OutputBank() :
+	_shadow{0},
+	_committed{0},
+	_switches{}
+	{
+
+	}
+
+	// Записывает тень во все каналы, не считая переключений. Вызывается после настройки выводов
+	void begin()
+	{
+		commitPort<Port::B>(kAllChannels);
+		commitPort<Port::C>(kAllChannels);
+		commitPort<Port::D>(kAllChannels);
+		_committed = _shadow;
+	}
+
+	void set(uint8_t aChannel, bool aState)
+	{
+		if (aState) {
+			_shadow |= 1 << aChannel;
+		} else {
+			_shadow &= ~(1 << aChannel);
+		}
+	}
+
+	bool get(uint8_t aChannel) const
+	{
+		return _shadow & (1 << aChannel);
+	}
+
+	void commit()
+	{
+		const uint8_t changed = _shadow ^ _committed;
+		if (!changed) {
+			return;
+		}
+
+		commitPort<Port::B>(changed);
+		commitPort<Port::C>(changed);
+		commitPort<Port::D>(changed);
+
+		for (uint8_t channel = 0; channel < kCount; ++channel) {
+			if (changed & (1 << channel)) {
+				++_switches[channel];
+			}
+		}
+		_committed = _shadow;
+	}
+
+	// Число переключений канала с момента старта
+	uint32_t switches(uint8_t aChannel) const
+	{
+		return _switches[aChannel];
+	}
+
+private:
+	static constexpr uint8_t kAllChannels{static_cast<uint8_t>((1U << kCount) - 1)};
+	static constexpr Port kPorts[kCount] = {Pins::kPort...};
+	static constexpr uint8_t kMasks[kCount] = {Pins::kMask...};
+
+	static constexpr uint8_t channelsOn(Port aPort)
+	{
+		uint8_t result{0};
+		for (uint8_t channel = 0; channel < kCount; ++channel) {
+			if (kPorts[channel] == aPort) {
+				result |= 1 << channel;
+			}
+		}
+		return result;
+	}
+
+	template<Port P>
+	void commitPort(uint8_t aChanged)
+	{
+		const uint8_t changed = aChanged & channelsOn(P);
+		if (!changed) {
+			return;
+		}
+
+		uint8_t mask{0};
+		uint8_t value{0};
+		for (uint8_t channel = 0; channel < kCount; ++channel) {
+			if (changed & (1 << channel)) {
+				mask |= kMasks[channel];
+				if (_shadow & (1 << channel)) {
+					value |= kMasks[channel];
+				}
+			}
+		}
+		portWrite<P>(mask, value);
+	}
+
+	uint8_t _shadow;
+	uint8_t _committed;
+	uint32_t _switches[kCount];
+};
+
+template<typename... Pins>
+constexpr Port OutputBank<Pins...>::kPorts[];
+
+template<typename... Pins>
+constexpr uint8_t OutputBank<Pins...>::kMasks[];
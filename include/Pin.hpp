@@ -0,0 +1,137 @@
+//
+// Pin.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Выводы как типы. Порт и бит известны при компиляции, поэтому на AVR каждая операция
+// с одним выводом собирается в одну инструкцию sbi/cbi/sbic. В хостовой сборке операции
+// уходят в фейковые функции HAL
+
+#pragma once
+
+#include "PinMap.hpp"
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/io.h>
+#include <util/atomic.h>
+
+template<Port P>
+struct PortRegisters;
+
+template<>
+struct PortRegisters<Port::B> {
+	static volatile uint8_t &out() { return PORTB; }
+	static volatile uint8_t &dir() { return DDRB; }
+	static volatile uint8_t &in() { return PINB; }
+};
+
+template<>
+struct PortRegisters<Port::C> {
+	static volatile uint8_t &out() { return PORTC; }
+	static volatile uint8_t &dir() { return DDRC; }
+	static volatile uint8_t &in() { return PINC; }
+};
+
+template<>
+struct PortRegisters<Port::D> {
+	static volatile uint8_t &out() { return PORTD; }
+	static volatile uint8_t &dir() { return DDRD; }
+	static volatile uint8_t &in() { return PIND; }
+};
+#else
+#include "Hal.hpp"
+#endif
+
+// Маскированная запись нескольких битов порта
+template<Port P>
+inline void portWrite(uint8_t aMask, uint8_t aValue)
+{
+#ifdef __AVR__
+	// Запрет прерываний: обработчики прерываний тоже пишут в порты
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		PortRegisters<P>::out() = (PortRegisters<P>::out() & ~aMask) | (aValue & aMask);
+	}
+#else
+	Hal::portWrite(P, aMask, aValue);
+#endif
+}
+
+template<uint8_t Pin>
+class OutputPin {
+public:
+	static constexpr uint8_t kPin{Pin};
+	static constexpr Port kPort{pinPort(Pin)};
+	static constexpr uint8_t kMask{pinMask(Pin)};
+
+	// Выход с низким уровнем
+	static void init()
+	{
+#ifdef __AVR__
+		PortRegisters<kPort>::out() &= ~kMask;
+		PortRegisters<kPort>::dir() |= kMask;
+#else
+		Hal::gpioMode(Pin, Hal::PinMode::OUT);
+#endif
+	}
+
+	static void high()
+	{
+#ifdef __AVR__
+		PortRegisters<kPort>::out() |= kMask;
+#else
+		Hal::gpioWrite(Pin, true);
+#endif
+	}
+
+	static void low()
+	{
+#ifdef __AVR__
+		PortRegisters<kPort>::out() &= ~kMask;
+#else
+		Hal::gpioWrite(Pin, false);
+#endif
+	}
+
+	static void set(bool aState)
+	{
+		if (aState) {
+			high();
+		} else {
+			low();
+		}
+	}
+};
+
+template<uint8_t Pin, bool Pullup = true>
+class InputPin {
+public:
+	static constexpr uint8_t kPin{Pin};
+	static constexpr Port kPort{pinPort(Pin)};
+	static constexpr uint8_t kMask{pinMask(Pin)};
+
+	static void init()
+	{
+#ifdef __AVR__
+		PortRegisters<kPort>::dir() &= ~kMask;
+		if (Pullup) {
+			PortRegisters<kPort>::out() |= kMask;
+		} else {
+			PortRegisters<kPort>::out() &= ~kMask;
+		}
+#else
+		Hal::gpioMode(Pin, Pullup ? Hal::PinMode::IN_PULLUP : Hal::PinMode::IN);
+#endif
+	}
+
+	static bool read()
+	{
+#ifdef __AVR__
+		return PortRegisters<kPort>::in() & kMask;
+#else
+		return Hal::gpioRead(Pin);
+#endif
+	}
+};
@@ -0,0 +1,28 @@
+//
+// PinMap.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Порты ATmega328 и номера выводов Arduino Nano: D0-D7 - PORTD, D8-D13 - PORTB, A0-A5 (14-19) - PORTC
+
+#pragma once
+
+#include <stdint.h>
+
+enum class Port : uint8_t {
+	B,
+	C,
+	D
+};
+
+constexpr Port pinPort(uint8_t aPin)
+{
+	return aPin < 8 ? Port::D : (aPin < 14 ? Port::B : Port::C);
+}
+
+constexpr uint8_t pinMask(uint8_t aPin)
+{
+	return 1 << (aPin < 8 ? aPin : (aPin < 14 ? aPin - 8 : aPin - 14));
+}
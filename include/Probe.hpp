@@ -0,0 +1,105 @@
+//
+// Probe.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Пересчет отсчетов АЦП датчиков в единицы: pH, проводимость и температура раствора.
+// Все в целых числах с фиксированной точкой: pH в сотых, проводимость в мкСм/см, температура
+// в десятых градуса. pH и проводимость калибруются по двум точкам - растворам с известным
+// значением, между точками и за ними пересчет линейный
+
+#pragma once
+
+#include "Flash.hpp"
+#include "Hal.hpp"
+#include <stdint.h>
+
+struct ProbeCalibration {
+	uint16_t raw[2]; // Отсчеты АЦП в точках калибровки
+	int16_t value[2]; // Значения калибровочных растворов
+};
+
+namespace Probe {
+
+static constexpr uint16_t kAdcFullScale{1U << Hal::kAdcBits};
+static constexpr int16_t kNoTemperature{INT16_MIN};
+static constexpr int16_t kReferenceTemperature{250}; // Проводимость приводится к 25 градусам
+static constexpr int16_t kEcTemperatureCoefficient{19}; // 1.9 %/градус в десятитысячных на десятую градуса
+static constexpr uint16_t kMinRawSpan{kAdcFullScale / 64}; // Около 78 мВ, точки ближе - калибровка по шуму
+static constexpr int32_t kMaxEc{INT32_MAX / 10000}; // Предел для термокомпенсации, произведение помещается в int32
+
+// pH 7.00 около 2.5 В и наклон -0.17 В/pH типичной платы усилителя
+static constexpr ProbeCalibration kPhDefault{{9861, 8192}, {400, 700}};
+// Линейный выход платы проводимости: 0 В - 0, 3.4 В - 20 мСм/см
+static constexpr ProbeCalibration kEcDefault{{0, 11141}, {0, 20000}};
+
+// NTC 10 кОм (B 3950) к земле и 10 кОм к питанию на входе температуры. Температура в десятых
+// градуса для отсчетов через каждые kAdcFullScale / 32, между ними линейно
+static const int16_t kNtcTable[33] PROGMEM = {1500, 1293, 1016, 866, 763, 685, 621, 567, 520, 477, 439, 403, 370,
+	338, 308, 278, 250, 222, 194, 167, 139, 111, 83, 53, 22, -11, -47, -87, -132, -186, -256, -364, -400};
+static constexpr uint16_t kNtcStep{kAdcFullScale / 32};
+static constexpr uint16_t kNtcShorted{kNtcStep / 2}; // Ближе к краям - обрыв или замыкание датчика
+static constexpr uint16_t kNtcOpen{kAdcFullScale - kNtcStep / 2};
+
+// Калибровка пригодна, если точки различаются по значениям, а по отсчетам отстоят хотя бы на kMinRawSpan:
+// у близких точек наклон прямой определяет шум АЦП
+inline bool valid(const ProbeCalibration &aCalibration)
+{
+	const uint16_t rawSpan = aCalibration.raw[0] > aCalibration.raw[1] ? aCalibration.raw[0] - aCalibration.raw[1]
+		: aCalibration.raw[1] - aCalibration.raw[0];
+
+	return rawSpan >= kMinRawSpan && aCalibration.value[0] != aCalibration.value[1]
+		&& aCalibration.raw[0] < kAdcFullScale && aCalibration.raw[1] < kAdcFullScale;
+}
+
+// Значение по прямой через две точки калибровки
+inline int32_t apply(const ProbeCalibration &aCalibration, uint16_t aRaw)
+{
+	const int32_t rawSpan = static_cast<int32_t>(aCalibration.raw[1]) - aCalibration.raw[0];
+	const int32_t valueSpan = static_cast<int32_t>(aCalibration.value[1]) - aCalibration.value[0];
+	const int32_t offset = static_cast<int32_t>(aRaw) - aCalibration.raw[0];
+
+	// Произведение до 2^14 * 2^16 помещается в int32
+	return aCalibration.value[0] + offset * valueSpan / rawSpan;
+}
+
+// Температура в десятых градуса или kNoTemperature, если датчик оборван или замкнут
+inline int16_t temperature(uint16_t aRaw)
+{
+	if (aRaw < kNtcShorted || aRaw > kNtcOpen) {
+		return kNoTemperature;
+	}
+
+	const uint8_t index = aRaw / kNtcStep;
+	const int16_t low = static_cast<int16_t>(pgm_read_word(&kNtcTable[index]));
+	const int16_t high = static_cast<int16_t>(pgm_read_word(&kNtcTable[index + 1]));
+	return low + static_cast<int16_t>(static_cast<int32_t>(high - low) * (aRaw % kNtcStep) / kNtcStep);
+}
+
+// Проводимость, приведенная к 25 градусам: EC25 = EC / (1 + a * (t - 25)). Значение за пределами
+// kMaxEc ограничивается до умножения, такая проводимость все равно выходит за шкалу
+inline int32_t compensateEc(int32_t aEc, int16_t aTemperature)
+{
+	if (aTemperature == kNoTemperature) {
+		return aEc;
+	}
+
+	const int32_t ec = aEc > kMaxEc ? kMaxEc : (aEc < -kMaxEc ? -kMaxEc : aEc);
+	const int32_t factor = 10000 + static_cast<int32_t>(kEcTemperatureCoefficient) * (aTemperature - kReferenceTemperature);
+	return factor > 0 ? ec * 10000 / factor : ec;
+}
+
+// Обратный пересчет: проводимость при температуре aTemperature раствора, у которого при 25 градусах aEc25
+inline int32_t uncompensateEc(int32_t aEc25, int16_t aTemperature)
+{
+	if (aTemperature == kNoTemperature) {
+		return aEc25;
+	}
+
+	const int32_t factor = 10000 + static_cast<int32_t>(kEcTemperatureCoefficient) * (aTemperature - kReferenceTemperature);
+	return factor > 0 ? aEc25 * factor / 10000 : aEc25;
+}
+
+} // namespace Probe
@@ -0,0 +1,152 @@
+//
+// Profiler.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Профилировщик участков главного цикла по тикам аппаратного таймера (Hal::ticks()). На участок
+// копятся число проходов, минимум, среднее и максимум, грубая гистограмма длительностей и число
+// проходов дольше бюджета. Сборка без PROFILER оставляет пустые start() и stop(): ни таймер,
+// ни память под статистику в прошивку не попадают
+
+#pragma once
+
+#include "Flash.hpp"
+#include "Hal.hpp"
+#include <stdint.h>
+
+namespace Profiler {
+
+static constexpr uint8_t kBuckets{8};
+static constexpr uint8_t kFirstBucketTicks{16}; // Граница первой корзины, каждая следующая вчетверо больше
+
+#ifdef PROFILER
+static constexpr bool kEnabled{true};
+#else
+static constexpr bool kEnabled{false};
+#endif
+
+struct Stats {
+	uint32_t count;
+	uint32_t total; // Тики
+	uint16_t min; // Тики, длиннее UINT16_MAX записываются как UINT16_MAX
+	uint16_t max;
+	uint16_t overruns; // Проходов дольше бюджета
+	uint16_t histogram[kBuckets]; // Последняя корзина - все, что длиннее предпоследней границы
+};
+
+// Верхняя граница корзины в тиках
+inline uint32_t bucketLimit(uint8_t aBucket)
+{
+	return static_cast<uint32_t>(kFirstBucketTicks) << (2 * aBucket);
+}
+
+inline uint8_t bucket(uint32_t aTicks)
+{
+	uint8_t index{0};
+	while (index < kBuckets - 1 && aTicks >= bucketLimit(index)) {
+		++index;
+	}
+	return index;
+}
+
+inline uint32_t toMicros(uint32_t aTicks)
+{
+	return aTicks * Hal::kTickMicros;
+}
+
+} // namespace Profiler
+
+#ifdef PROFILER
+
+// Бюджеты участков в микросекундах лежат во flash
+template<uint8_t Sections>
+class LoopProfiler {
+public:
+	explicit LoopProfiler(const uint16_t *aBudgets) :
+	_budgets{aBudgets},
+	_stats{}
+	{
+		for (auto &stats : _stats) {
+			stats.min = UINT16_MAX;
+		}
+	}
+
+	uint32_t start() const
+	{
+		return Hal::ticks();
+	}
+
+	void stop(uint8_t aSection, uint32_t aStart)
+	{
+		const uint32_t ticks = Hal::ticks() - aStart;
+		const uint16_t clipped = ticks < UINT16_MAX ? static_cast<uint16_t>(ticks) : UINT16_MAX;
+		Profiler::Stats &stats = _stats[aSection];
+
+		// Перед переполнением сумма и счетчик делятся пополам: среднее сохраняется, старые проходы весят меньше
+		if (stats.total > UINT32_MAX - ticks || stats.count == UINT32_MAX) {
+			stats.total /= 2;
+			stats.count /= 2;
+		}
+		stats.total += ticks;
+		++stats.count;
+
+		if (clipped < stats.min) {
+			stats.min = clipped;
+		}
+		if (clipped > stats.max) {
+			stats.max = clipped;
+		}
+
+		if (Profiler::toMicros(ticks) > pgm_read_word(&_budgets[aSection]) && stats.overruns < UINT16_MAX) {
+			++stats.overruns;
+		}
+
+		// Гистограмма тоже делится пополам, соотношение корзин остается
+		uint16_t &count = stats.histogram[Profiler::bucket(ticks)];
+		if (count == UINT16_MAX) {
+			for (auto &entry : stats.histogram) {
+				entry /= 2;
+			}
+		}
+		++count;
+	}
+
+	const Profiler::Stats &stats(uint8_t aSection) const
+	{
+		return _stats[aSection];
+	}
+
+	uint16_t budget(uint8_t aSection) const
+	{
+		return pgm_read_word(&_budgets[aSection]);
+	}
+
+private:
+	const uint16_t *_budgets;
+	Profiler::Stats _stats[Sections];
+};
+
+#else
+
+template<uint8_t Sections>
+class LoopProfiler {
+public:
+	explicit LoopProfiler(const uint16_t *)
+	{
+
+	}
+
+	uint32_t start() const
+	{
+		return 0;
+	}
+
+	void stop(uint8_t, uint32_t)
+	{
+
+	}
+};
+
+#endif
@@ -0,0 +1,54 @@
+//
+// PumpPhase.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Фаза цикла залив-отлив как функция времени. Циклы идут подряд от эпохи - момента, с которого
+// начался залив, поэтому после перезагрузки или перевода часов фаза просто вычисляется заново,
+// без досчитывания пропущенных переключений
+
+#pragma once
+
+#include <stdint.h>
+
+namespace PumpPhase {
+
+static constexpr uint32_t kNoEpoch{0xFFFFFFFF}; // Стертая EEPROM
+
+struct Phase {
+	bool flood;
+	uint32_t start; // Начало текущей фазы
+	uint32_t next; // Начало следующей фазы
+};
+
+// Фаза в момент aNow, длительности залива и отлива в секундах. Время до эпохи тоже допустимо
+inline Phase at(uint32_t aNow, uint32_t aEpoch, uint32_t aFlood, uint32_t aDrain)
+{
+	const uint32_t cycle = aFlood + aDrain;
+	if (!cycle) {
+		return Phase{false, aNow, aNow + 1};
+	}
+
+	uint32_t offset;
+	if (static_cast<int32_t>(aNow - aEpoch) >= 0) {
+		offset = (aNow - aEpoch) % cycle;
+	} else {
+		offset = (cycle - (aEpoch - aNow) % cycle) % cycle;
+	}
+
+	const uint32_t cycleStart = aNow - offset;
+	if (offset < aFlood) {
+		return Phase{true, cycleStart, cycleStart + aFlood};
+	}
+	return Phase{false, cycleStart + aFlood, cycleStart + cycle};
+}
+
+// Эпоха, при которой фаза aPhase сохранит свое начало с новой длительностью залива
+inline uint32_t anchor(const Phase &aPhase, uint32_t aFlood)
+{
+	return aPhase.flood ? aPhase.start : aPhase.start - aFlood;
+}
+
+} // namespace PumpPhase
@@ -0,0 +1,85 @@
+//
+// RingBuffer.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Кольцевая очередь на один писатель и один читатель, например прерывание и главный цикл.
+// Индексы однобайтовые и меняются только своей стороной, поэтому запрет прерываний не нужен.
+// Capacity - степень двойки не больше 128
+
+#pragma once
+
+#include <stdint.h>
+
+template<typename T, uint8_t Capacity>
+class RingBuffer {
+	static_assert(Capacity && Capacity <= 128 && (Capacity & (Capacity - 1)) == 0,
+		"Capacity must be a power of two up to 128");
+
+public:
+	RingBuffer() :
+	_head{0},
+	_tail{0}
+	{
+
+	}
+
+	// Вызывается только писателем. При переполнении элемент отбрасывается
+	bool push(const T &aItem)
+	{
+		const uint8_t head = _head;
+		if (static_cast<uint8_t>(head - _tail) >= Capacity) {
+			return false;
+		}
+
+		_data[head & kMask] = aItem;
+		barrier(); // Данные должны лечь в буфер раньше, чем читатель увидит новый индекс
+		_head = head + 1;
+		return true;
+	}
+
+	// Вызывается только читателем
+	bool pop(T &aItem)
+	{
+		const uint8_t tail = _tail;
+		if (tail == _head) {
+			return false;
+		}
+
+		aItem = _data[tail & kMask];
+		barrier();
+		_tail = tail + 1;
+		return true;
+	}
+
+	bool empty() const
+	{
+		return _tail == _head;
+	}
+
+	uint8_t size() const
+	{
+		return static_cast<uint8_t>(_head - _tail);
+	}
+
+	// Только когда писатель заведомо не работает
+	void clear()
+	{
+		_head = 0;
+		_tail = 0;
+	}
+
+private:
+	static constexpr uint8_t kMask{Capacity - 1};
+
+	static void barrier()
+	{
+		__asm__ __volatile__("" ::: "memory");
+	}
+
+	T _data[Capacity];
+	volatile uint8_t _head;
+	volatile uint8_t _tail;
+};
@@ -0,0 +1,184 @@
+//
+// RotaryEncoder.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Декодер энкодера с кнопкой, работающий из прерывания по изменению уровня выводов.
+// Повороты декодируются по таблице переходов кода Грея, шаг засчитывается при возврате в детент.
+// Кнопка отрабатывается по первому фронту, следующие фронты в течение kKeyDebounceTime игнорируются.
+// События копятся в короткой очереди в порядке поступления, подряд идущие шаги в одну сторону
+// складываются в одну запись со счетчиком. Поэтому быстрое вращение не теряется, даже если главный
+// цикл надолго занят, а нажатие посреди вращения не обгоняет шаги перед ним. Главный цикл разбирает
+// накопленное через pop()
+
+#pragma once
+
+#include "Flash.hpp"
+#include <stdint.h>
+
+struct EncoderEvent {
+	enum class Type : uint8_t {
+		RIGHT,
+		LEFT,
+		PRESS,
+		HOLD
+	};
+
+	Type type;
+	uint8_t interval; // Для поворотов: миллисекунды от предыдущего шага в ту же сторону, не больше 255
+};
+
+// Индекс - предыдущее и текущее состояние выводов (A << 1 | B), значение - направление перехода
+static const int8_t kEncoderTransitions[16] PROGMEM = {
+	0, -1,  1,  0,
+	1,  0,  0, -1,
+	-1, 0,  0,  1,
+	0,  1, -1,  0
+};
+
+class RotaryEncoder {
+public:
+	static constexpr uint8_t kKeyDebounceTime{20};
+	static constexpr uint16_t kHoldTime{1000};
+	static constexpr uint8_t kQueueSize{8}; // Записей, шаги в одну сторону занимают одну
+
+	RotaryEncoder() :
+	_keyEdgeTime{0},
+	_lastStepTime{0},
+	_queue{},
+	_state{kDetent},
+	_position{0},
+	_lastDirection{0},
+	_first{0},
+	_size{0},
+	_keyDown{false},
+	_holdSent{false}
+	{
+
+	}
+
+	// Уровни выводов, кнопка нажата низким уровнем
+	void begin(bool aA, bool aB, bool aKey)
+	{
+		_state = (aA << 1) | aB;
+		_position = 0;
+		_first = 0;
+		_size = 0;
+		_keyDown = !aKey;
+		_holdSent = true; // Кнопка, зажатая при старте, не дает удержания
+	}
+
+	// Из прерывания по изменению любого из выводов
+	void onChange(bool aA, bool aB, bool aKey, uint32_t aNow)
+	{
+		rotate(aA, aB, aNow);
+		key(aKey, aNow);
+	}
+
+	// Из главного цикла при запрещенных прерываниях, по одному событию за вызов в порядке поступления.
+	// Здесь же определяется удержание и дорабатывается отпускание кнопки, фронт которого попал в антидребезг
+	bool pop(EncoderEvent &aEvent, bool aKey, uint32_t aNow)
+	{
+		key(aKey, aNow);
+
+		if (_keyDown && !_holdSent && aNow - _keyEdgeTime >= kHoldTime) {
+			_holdSent = push(EncoderEvent::Type::HOLD, 0); // Очередь полна - удержание встанет следующим вызовом
+		}
+
+		if (!_size) {
+			return false;
+		}
+
+		Entry &entry = _queue[_first];
+		aEvent = EncoderEvent{entry.type, entry.interval};
+		if (!--entry.count) {
+			_first = (_first + 1) % kQueueSize;
+			--_size;
+		}
+		return true;
+	}
+
+private:
+	static constexpr uint8_t kDetent{0x03}; // Оба вывода подтянуты
+
+	struct Entry {
+		EncoderEvent::Type type;
+		uint8_t count; // Шагов в записи, для нажатий и удержания 1
+		uint8_t interval; // Интервал последнего шага записи, по нему главный цикл выбирает ускорение
+	};
+
+	// Шаг в ту же сторону, что и последняя запись, прибавляется к ней. Переполненная очередь
+	// отбрасывает новое событие
+	bool push(EncoderEvent::Type aType, uint8_t aInterval)
+	{
+		const bool step = aType == EncoderEvent::Type::RIGHT || aType == EncoderEvent::Type::LEFT;
+
+		if (step && _size) {
+			Entry &last = _queue[(_first + _size - 1) % kQueueSize];
+			if (last.type == aType && last.count < UINT8_MAX) {
+				++last.count;
+				last.interval = aInterval;
+				return true;
+			}
+		}
+
+		if (_size >= kQueueSize) {
+			return false;
+		}
+		_queue[(_first + _size) % kQueueSize] = Entry{aType, 1, aInterval};
+		++_size;
+		return true;
+	}
+
+	void rotate(bool aA, bool aB, uint32_t aNow)
+	{
+		const uint8_t state = (aA << 1) | aB;
+		_position += static_cast<int8_t>(pgm_read_byte(&kEncoderTransitions[(_state << 2) | state]));
+		_state = state;
+
+		if (state != kDetent) {
+			return;
+		}
+
+		if (_position >= 2 || _position <= -2) {
+			const int8_t direction = _position > 0 ? 1 : -1;
+			const uint32_t interval = direction == _lastDirection ? aNow - _lastStepTime : UINT8_MAX;
+
+			push(direction > 0 ? EncoderEvent::Type::RIGHT : EncoderEvent::Type::LEFT,
+				interval > UINT8_MAX ? UINT8_MAX : static_cast<uint8_t>(interval));
+			_lastDirection = direction;
+			_lastStepTime = aNow;
+		}
+		_position = 0;
+	}
+
+	void key(bool aKey, uint32_t aNow)
+	{
+		const bool down = !aKey;
+		if (down == _keyDown || aNow - _keyEdgeTime < kKeyDebounceTime) {
+			return;
+		}
+
+		_keyDown = down;
+		_keyEdgeTime = aNow;
+
+		if (down) {
+			_holdSent = false;
+		} else if (!_holdSent) {
+			push(EncoderEvent::Type::PRESS, 0);
+		}
+	}
+
+	uint32_t _keyEdgeTime;
+	uint32_t _lastStepTime;
+	Entry _queue[kQueueSize];
+	uint8_t _state;
+	int8_t _position;
+	int8_t _lastDirection;
+	uint8_t _first; // Самая старая запись очереди
+	uint8_t _size;
+	bool _keyDown;
+	bool _holdSent;
+};
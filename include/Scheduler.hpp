@@ -0,0 +1,196 @@
+//
+// Scheduler.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Кооперативный планировщик на фиксированном массиве. Задачи лежат в двоичной куче по сроку запуска,
+// так что проход цикла проверяет только вершину кучи. Сроки в миллисекундах и сравниваются через
+// разность, поэтому переполнение millis() не ломает порядок (пока сроки ближе 24 дней друг к другу).
+// Задача запускается один раз, для повторного запуска обработчик сам вызывает schedule().
+// Для каждой задачи копится статистика опоздания относительно срока
+
+#pragma once
+
+#include <stdint.h>
+
+template<uint8_t Capacity>
+class Scheduler {
+public:
+	using Handler = void (*)();
+
+	struct Stats {
+		uint32_t runs;
+		uint32_t lateSum; // Миллисекунды
+		uint16_t lateMax; // Миллисекунды
+	};
+
+	static constexpr uint8_t kNoTask{0xFF};
+
+	Scheduler() :
+	_tasks{},
+	_heap{},
+	_taskCount{0},
+	_heapSize{0}
+	{
+
+	}
+
+	// Регистрирует задачу, возвращает ее номер или kNoTask, если места нет. Задача не запланирована
+	uint8_t add(Handler aHandler)
+	{
+		if (_taskCount >= Capacity) {
+			return kNoTask;
+		}
+
+		Task &task = _tasks[_taskCount];
+		task.handler = aHandler;
+		task.position = kNoTask;
+		task.stats = Stats{0, 0, 0};
+		return _taskCount++;
+	}
+
+	// Ставит или переносит срок запуска задачи
+	void schedule(uint8_t aTask, uint32_t aDeadline)
+	{
+		Task &task = _tasks[aTask];
+		task.deadline = aDeadline;
+
+		if (task.position == kNoTask) {
+			task.position = _heapSize;
+			_heap[_heapSize++] = aTask;
+			siftUp(task.position);
+		} else {
+			siftUp(task.position);
+			siftDown(task.position);
+		}
+	}
+
+	void cancel(uint8_t aTask)
+	{
+		const uint8_t position = _tasks[aTask].position;
+		if (position == kNoTask) {
+			return;
+		}
+
+		_tasks[aTask].position = kNoTask;
+		--_heapSize;
+
+		if (position < _heapSize) {
+			place(position, _heap[_heapSize]);
+			siftUp(position);
+			siftDown(position);
+		}
+	}
+
+	bool scheduled(uint8_t aTask) const
+	{
+		return _tasks[aTask].position != kNoTask;
+	}
+
+	// Срок запланированной задачи
+	uint32_t deadline(uint8_t aTask) const
+	{
+		return _tasks[aTask].deadline;
+	}
+
+	// Запускает все задачи, срок которых наступил
+	void run(uint32_t aNow)
+	{
+		while (_heapSize && before(_tasks[_heap[0]].deadline, aNow + 1)) {
+			const uint8_t id = _heap[0];
+			Task &task = _tasks[id];
+			const uint32_t late = aNow - task.deadline;
+
+			cancel(id);
+
+			++task.stats.runs;
+			task.stats.lateSum += late;
+			if (late > task.stats.lateMax) {
+				task.stats.lateMax = late > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(late);
+			}
+
+			task.handler();
+		}
+	}
+
+	const Stats &stats(uint8_t aTask) const
+	{
+		return _tasks[aTask].stats;
+	}
+
+	uint8_t size() const
+	{
+		return _taskCount;
+	}
+
+private:
+	struct Task {
+		Handler handler;
+		uint32_t deadline;
+		uint8_t position; // Позиция в куче или kNoTask
+		Stats stats;
+	};
+
+	static bool before(uint32_t aFirst, uint32_t aSecond)
+	{
+		return static_cast<int32_t>(aFirst - aSecond) < 0;
+	}
+
+	bool less(uint8_t aFirst, uint8_t aSecond) const
+	{
+		return before(_tasks[_heap[aFirst]].deadline, _tasks[_heap[aSecond]].deadline);
+	}
+
+	void place(uint8_t aPosition, uint8_t aTask)
+	{
+		_heap[aPosition] = aTask;
+		_tasks[aTask].position = aPosition;
+	}
+
+	void swap(uint8_t aFirst, uint8_t aSecond)
+	{
+		const uint8_t task = _heap[aFirst];
+		place(aFirst, _heap[aSecond]);
+		place(aSecond, task);
+	}
+
+	void siftUp(uint8_t aPosition)
+	{
+		while (aPosition > 0) {
+			const uint8_t parent = (aPosition - 1) / 2;
+			if (!less(aPosition, parent)) {
+				break;
+			}
+			swap(aPosition, parent);
+			aPosition = parent;
+		}
+	}
+
+	void siftDown(uint8_t aPosition)
+	{
+		while (true) {
+			const uint8_t left = 2 * aPosition + 1;
+			const uint8_t right = left + 1;
+			uint8_t smallest = aPosition;
+
+			if (left < _heapSize && less(left, smallest)) {
+				smallest = left;
+			}
+			if (right < _heapSize && less(right, smallest)) {
+				smallest = right;
+			}
+			if (smallest == aPosition) {
+				break;
+			}
+			swap(aPosition, smallest);
+			aPosition = smallest;
+		}
+	}
+
+	Task _tasks[Capacity];
+	uint8_t _heap[Capacity];
+	uint8_t _taskCount;
+	uint8_t _heapSize;
+};
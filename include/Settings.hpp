@@ -0,0 +1,70 @@
+//
+// Settings.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Настройки установки в том виде, в котором они лежат в EEPROM
+
+#pragma once
+
+#include "ConfigStore.hpp"
+#include "Probe.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr uint8_t kLightPeriods{4}; // Периодов света в сутках
+
+enum class HydroTypes {
+	NORMAL,
+	SWING,
+};
+
+struct TimeContainerMinimal {
+	uint8_t hours;
+	uint8_t minutes;
+};
+
+struct LightPeriodMinimal {
+	TimeContainerMinimal on;
+	TimeContainerMinimal off;
+};
+
+struct EepromData {
+	uint8_t pumpOnPeriod;
+	uint8_t pumpOffPeriod;
+	TimeContainerMinimal lampOnTime;
+	TimeContainerMinimal lampOffTime;
+	uint8_t swingOffPeriod;
+	HydroTypes hydroType;
+	uint16_t maxTimeForFullFlood;
+	LightPeriodMinimal lampPeriods[kLightPeriods - 1]; // Периоды после первого, первый - lampOnTime и lampOffTime
+	uint8_t sunriseTime; // Рассвет и закат лампы в минутах
+	uint8_t sunsetTime;
+	uint32_t pumpEpoch; // Начало отсчета циклов насоса, см. PumpPhase.hpp
+	ProbeCalibration phCalibration;
+	ProbeCalibration ecCalibration;
+	uint8_t pumpLocked; // Насос заблокирован критической ошибкой, блокировка переживает перезагрузку
+	uint16_t floodCycles; // Счетчики статистики, насыщаются на UINT16_MAX
+	uint16_t errors;
+};
+
+// Версии схемы. Поля только дописываются в конец, поэтому запись старой версии - начало новой:
+// 1 - насос, одно окно лампы, качели, режим, время залива (так же лежала прежняя запись без заголовка по адресу 0)
+// 2 - дополнительные периоды света, рассвет и закат, эпоха насоса
+// 3 - калибровка датчиков pH и проводимости
+// 4 - блокировка насоса
+// 5 - счетчики удачных циклов залива и ошибок
+static constexpr uint8_t kSettingsVersion{5};
+static constexpr uint8_t kSettingsV1Size{offsetof(EepromData, lampPeriods)};
+
+// Кольцо настроек занимает первую половину EEPROM, журнал событий - вторую
+static constexpr uint16_t kSettingsAddress{0};
+static constexpr uint8_t kSettingsSlots{8};
+static constexpr uint8_t kSettingsSlotSize{64};
+
+static constexpr uint16_t kLogAddress{512};
+static constexpr uint16_t kLogSize{512};
+
+using SettingsStore = ConfigStore<EepromData, kSettingsAddress, kSettingsSlots, kSettingsSlotSize>;
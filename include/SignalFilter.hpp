@@ -0,0 +1,107 @@
+//
+// SignalFilter.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Целочисленные фильтры отсчетов АЦП. Медиана по скользящему окну выкидывает одиночные выбросы
+// (помехи от насоса и реле), экспоненциальное сглаживание после нее убирает остаточный шум.
+// Без плавающей точки: на AVR она тянет библиотеку и считается в десятки раз дольше
+
+#pragma once
+
+#include <stdint.h>
+
+// Медиана последних Size отсчетов, Size нечетный и небольшой: окно сортируется вставками
+template<uint8_t Size>
+class MedianFilter {
+	static_assert(Size % 2 == 1, "Median window must be odd");
+
+public:
+	MedianFilter() :
+	_window{},
+	_position{0},
+	_count{0}
+	{
+
+	}
+
+	// Добавляет отсчет и возвращает медиану. Пока окно не заполнено, медиана по тому, что есть
+	uint16_t push(uint16_t aValue)
+	{
+		_window[_position] = aValue;
+		_position = _position + 1 < Size ? _position + 1 : 0;
+		if (_count < Size) {
+			++_count;
+		}
+
+		uint16_t sorted[Size];
+		for (uint8_t i = 0; i < _count; ++i) {
+			uint8_t j = i;
+			for (; j && sorted[j - 1] > _window[i]; --j) {
+				sorted[j] = sorted[j - 1];
+			}
+			sorted[j] = _window[i];
+		}
+		return sorted[_count / 2];
+	}
+
+	void reset()
+	{
+		_position = 0;
+		_count = 0;
+	}
+
+private:
+	uint16_t _window[Size];
+	uint8_t _position;
+	uint8_t _count;
+};
+
+// y += (x - y) / 2^Shift. Состояние хранится умноженным на 2^Shift, так что дробная часть не теряется.
+// Постоянная времени - около 2^Shift отсчетов
+template<uint8_t Shift>
+class IirFilter {
+	static_assert(Shift > 0 && Shift < 16, "Shift must be in 1..15");
+
+public:
+	IirFilter() :
+	_state{0},
+	_primed{false}
+	{
+
+	}
+
+	uint16_t push(uint16_t aValue)
+	{
+		if (!_primed) {
+			// Первый отсчет сразу становится значением, иначе фильтр долго выползает из нуля
+			_state = static_cast<uint32_t>(aValue) << Shift;
+			_primed = true;
+		} else {
+			_state = _state + aValue - (_state >> Shift);
+		}
+		return value();
+	}
+
+	uint16_t value() const
+	{
+		return static_cast<uint16_t>((_state + (1UL << (Shift - 1))) >> Shift);
+	}
+
+	bool primed() const
+	{
+		return _primed;
+	}
+
+	void reset()
+	{
+		_state = 0;
+		_primed = false;
+	}
+
+private:
+	uint32_t _state;
+	bool _primed;
+};
@@ -0,0 +1,262 @@
+//
+// Ssd1306Text.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Текстовый вывод на SSD1306 128x32 без видеобуфера в RAM. Хранятся только строки текста,
+// при отправке каждая страница (8 строк пикселей) собирается по столбцам прямо из шрифта во flash
+// и сразу уходит в контроллер. Страницы, содержимое которых не изменилось, не отправляются.
+// Отправка не блокирует: flush() только отмечает страницы, service() отдает шине столько кусков,
+// сколько она готова принять, и продолжает со следующего вызова. refresh() заставляет следующий flush()
+// повторить настройку контроллера и все страницы, так экран восстанавливается после помехи или
+// пропадания его питания.
+//
+// Bus должен предоставлять static bool ready() и static bool write(uint8_t aControl, const uint8_t *aData,
+// uint8_t aCount), где aControl - управляющий байт SSD1306 (0x00 команды, 0x40 данные),
+// aCount не больше Bus::kChunk, write() возвращает false, если кусок не принят
+
+#pragma once
+
+#include "Flash.hpp"
+#include "Font5x7.hpp"
+#include "Hash.hpp"
+#include <stdint.h>
+
+// Инициализация 128x32: питание от встроенного преобразователя, горизонтальная адресация
+static const uint8_t kSsd1306Init[] PROGMEM = {
+	0xAE,       // Выключить
+	0xD5, 0x80, // Делитель частоты
+	0xA8, 0x1F, // Мультиплекс на 32 строки
+	0xD3, 0x00, // Смещение
+	0x40,       // Начальная строка 0
+	0x8D, 0x14, // Встроенный преобразователь
+	0x20, 0x00, // Горизонтальная адресация
+	0xA1,       // Ремап сегментов
+	0xC8,       // Направление сканирования строк
+	0xDA, 0x02, // Конфигурация выводов COM для 32 строк
+	0x81, 0x8F, // Контраст
+	0xD9, 0xF1, // Предзаряд
+	0xDB, 0x40, // VCOMH
+	0xA4,       // Вывод из RAM
+	0xA6,       // Нормальный, не инверсный
+	0x2E,       // Без прокрутки
+	0xAF        // Включить
+};
+
+template<typename Bus, uint8_t Items = 2, uint8_t Length = 21>
+class Ssd1306Text {
+public:
+	static constexpr uint8_t kWidth{128};
+	static constexpr uint8_t kPages{4};
+	static constexpr uint8_t kCellWidth{kFontGlyphColumns + 1};
+	static constexpr uint8_t kCommandControl{0x00};
+	static constexpr uint8_t kDataControl{0x40};
+
+	Ssd1306Text() :
+	_count{0},
+	_keysValid{false},
+	_dirty{0},
+	_x{0},
+	_windowSent{false},
+	_flipped{false},
+	_configPending{false}
+	{
+
+	}
+
+	// aFlipped - экран повернут на 180 градусов, поворот делает сам контроллер
+	void init(bool aFlipped)
+	{
+		_flipped = aFlipped;
+		while (!sendConfig(0)) {}
+		_count = 0;
+		_keysValid = false;
+		_dirty = 0;
+		_configPending = false;
+	}
+
+	// Следующий flush() отправит настройку и все страницы, даже не изменившиеся
+	void refresh()
+	{
+		_keysValid = false;
+		_configPending = true;
+	}
+
+	void clear()
+	{
+		_count = 0;
+	}
+
+	void print(uint8_t aX, uint8_t aY, const char *aText)
+	{
+		if (_count >= Items) {
+			return;
+		}
+
+		Item &item = _items[_count++];
+		item.x = aX;
+		item.y = aY;
+		item.length = 0;
+
+		while (*aText && item.length < Length) {
+			item.text[item.length++] = *aText++;
+		}
+	}
+
+	// Отмечает изменившиеся страницы и начинает их отправку. Текст нельзя менять, пока busy()
+	void flush()
+	{
+		for (uint8_t page = 0; page < kPages; ++page) {
+			const uint32_t key = pageKey(page);
+
+			if (!_keysValid || key != _keys[page]) {
+				_dirty |= 1 << page;
+				_keys[page] = key;
+			}
+		}
+
+		_keysValid = true;
+		_x = 0;
+		_windowSent = false;
+		service();
+	}
+
+	// Отдает шине очередные куски отмеченных страниц
+	void service()
+	{
+		while ((_configPending || _dirty) && Bus::ready()) {
+			if (_configPending) {
+				// Без первой команды: выключение погасило бы работающий экран
+				if (!sendConfig(1)) {
+					return;
+				}
+				_configPending = false;
+				continue;
+			}
+
+			uint8_t page{0};
+			while (!(_dirty & (1 << page))) {
+				++page;
+			}
+
+			if (!_windowSent) {
+				const uint8_t window[] = {0x22, page, page, 0x21, 0, kWidth - 1};
+				_windowSent = Bus::write(kCommandControl, window, sizeof(window));
+				continue;
+			}
+
+			uint8_t chunk[Bus::kChunk];
+			uint8_t count{0};
+			while (count < Bus::kChunk && _x + count < kWidth) {
+				chunk[count] = column(page, _x + count);
+				++count;
+			}
+
+			if (!Bus::write(kDataControl, chunk, count)) {
+				return;
+			}
+
+			_x += count;
+			if (_x >= kWidth) {
+				_dirty &= ~(1 << page);
+				_x = 0;
+				_windowSent = false;
+			}
+		}
+	}
+
+	bool busy() const
+	{
+		return _dirty || _configPending;
+	}
+
+private:
+	static constexpr uint8_t kSegmentRemapIndex{12};
+	static constexpr uint8_t kComScanIndex{13};
+
+	struct Item {
+		uint8_t x;
+		uint8_t y;
+		uint8_t length;
+		char text[Length];
+	};
+
+	// Команды настройки начиная с aFirst одним куском
+	bool sendConfig(uint8_t aFirst)
+	{
+		uint8_t commands[sizeof(kSsd1306Init)];
+		for (uint8_t i = 0; i < sizeof(kSsd1306Init); ++i) {
+			commands[i] = pgm_read_byte(&kSsd1306Init[i]);
+		}
+
+		if (_flipped) {
+			commands[kSegmentRemapIndex] = 0xA0;
+			commands[kComScanIndex] = 0xC0;
+		}
+
+		return Bus::write(kCommandControl, commands + aFirst, sizeof(commands) - aFirst);
+	}
+
+	bool onPage(const Item &aItem, uint8_t aPage) const
+	{
+		const int16_t top = aPage * 8;
+		return aItem.y + 8 > top && aItem.y < top + 8;
+	}
+
+	uint32_t pageKey(uint8_t aPage) const
+	{
+		uint32_t key = Hash::kFnvOffset;
+
+		for (uint8_t i = 0; i < _count; ++i) {
+			const Item &item = _items[i];
+			if (onPage(item, aPage)) {
+				key = Hash::fnv1a(&item, 3 + item.length, key);
+			}
+		}
+		return key;
+	}
+
+	// Столбец страницы, собранный из всех строк текста, которые ее задевают
+	uint8_t column(uint8_t aPage, uint8_t aX) const
+	{
+		uint8_t result{0};
+
+		for (uint8_t i = 0; i < _count; ++i) {
+			const Item &item = _items[i];
+			if (aX < item.x || !onPage(item, aPage)) {
+				continue;
+			}
+
+			const uint16_t offset = aX - item.x;
+			const uint8_t symbol = offset / kCellWidth;
+			const uint8_t glyphColumn = offset % kCellWidth;
+
+			if (symbol >= item.length || glyphColumn >= kFontGlyphColumns) {
+				continue;
+			}
+
+			char code = item.text[symbol];
+			if (code < kFontFirstChar || code > kFontLastChar) {
+				code = '?';
+			}
+
+			const uint8_t bits = pgm_read_byte(&kFont5x7[(code - kFontFirstChar) * kFontGlyphColumns + glyphColumn]);
+			const int8_t shift = item.y - aPage * 8;
+			result |= shift >= 0 ? static_cast<uint8_t>(bits << shift) : static_cast<uint8_t>(bits >> -shift);
+		}
+
+		return result;
+	}
+
+	Item _items[Items];
+	uint8_t _count;
+	uint32_t _keys[kPages];
+	bool _keysValid;
+	uint8_t _dirty; // Битовая маска страниц, ждущих отправки
+	uint8_t _x; // Следующий столбец текущей страницы
+	bool _windowSent;
+	bool _flipped;
+	bool _configPending; // Настройка ждет отправки перед страницами
+};
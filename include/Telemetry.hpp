@@ -0,0 +1,244 @@
+//
+// Telemetry.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Двоичный протокол телеметрии, общий для прошивки и хостового декодера (tools/telemetry).
+// Кадр до кодирования: тип, номер кадра, данные, CRC-16 по всему предыдущему (младший байт первым).
+// Кадр кодируется COBS и завершается нулем. Номер растет на единицу с каждым кадром, пропуск
+// номера на приемнике - потерянный кадр. Поля данных пишутся побайтно, младший байт первым,
+// раскладка не зависит от компилятора и выравнивания. Новые поля добавляются только в конец
+// данных, приемник читает известную ему часть и игнорирует хвост
+
+#pragma once
+
+#include "Cobs.hpp"
+#include "Crc.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Telemetry {
+
+enum class Type : uint8_t {
+	TEXT = 1, // Строка отладочного вывода без завершающего нуля
+	SNAPSHOT, // Снимок состояния
+	EVENT // Событие, номера из LogEvents
+};
+
+static constexpr uint8_t kMaxPayload{64};
+static constexpr uint8_t kOverhead{4}; // Тип, номер и CRC
+static constexpr uint8_t kMaxFrameSize{Cobs::maxEncodedSize(kMaxPayload + kOverhead) + 1};
+
+// Биты Snapshot::flags
+static constexpr uint8_t kFlagFloodPhase{0x01}; // Идет фаза залива
+static constexpr uint8_t kFlagPump{0x02}; // Насос включен
+static constexpr uint8_t kFlagSwing{0x04}; // Качели: насос доливает камеру
+static constexpr uint8_t kFlagLamp{0x08};
+static constexpr uint8_t kFlagFloat{0x10}; // Камера полна
+static constexpr uint8_t kFlagError{0x20};
+static constexpr uint8_t kFlagSetup{0x40}; // Открыто меню настройки
+static constexpr uint8_t kFlagLocked{0x80}; // Насос заблокирован после критической ошибки
+
+struct Snapshot {
+	uint32_t uptime; // Миллисекунды
+	uint32_t unixTime;
+	uint8_t flags;
+	uint8_t lampLevel;
+	uint8_t hydroType;
+	uint8_t floodTrips; // Заполнений камеры за текущий залив
+	uint16_t errors;
+	uint16_t successed;
+	uint32_t loops; // Проходов главного цикла с прошлого снимка
+	uint16_t loopMax; // Самый долгий проход с прошлого снимка, микросекунды
+	uint16_t dropped; // Кадров, не поместившихся в буфер передачи, с запуска
+	uint16_t ph; // Сотые
+	uint16_t ec; // мкСм/см при 25 градусах
+	int16_t temperature; // Десятые градуса, INT16_MIN - датчика нет
+	uint16_t stackFree; // Наименьший запас ОЗУ между кучей и стеком с запуска, байты
+	uint16_t heapFree; // Фрагментация кучи, байты
+};
+
+struct Event {
+	uint32_t time;
+	uint8_t type;
+	uint8_t argument;
+};
+
+// Размеры упакованных данных: pack() пишет ровно столько, это сверяет хостовая проверка (src/native/Checks.cpp)
+static constexpr uint8_t kSnapshotSize{34};
+static constexpr uint8_t kEventSize{6};
+
+static_assert(kSnapshotSize <= kMaxPayload && kEventSize <= kMaxPayload, "Payload does not fit into a frame");
+
+class Writer {
+public:
+	explicit Writer(uint8_t *aData) :
+	_data{aData},
+	_size{0}
+	{
+
+	}
+
+	Writer &u8(uint8_t aValue)
+	{
+		_data[_size++] = aValue;
+		return *this;
+	}
+
+	Writer &u16(uint16_t aValue)
+	{
+		return u8(static_cast<uint8_t>(aValue)).u8(static_cast<uint8_t>(aValue >> 8));
+	}
+
+	Writer &u32(uint32_t aValue)
+	{
+		return u16(static_cast<uint16_t>(aValue)).u16(static_cast<uint16_t>(aValue >> 16));
+	}
+
+	uint8_t size() const
+	{
+		return _size;
+	}
+
+private:
+	uint8_t *_data;
+	uint8_t _size;
+};
+
+// Чтение за концом данных дает нули и снимает ok()
+class Reader {
+public:
+	Reader(const uint8_t *aData, size_t aSize) :
+	_data{aData},
+	_size{aSize},
+	_position{0}
+	{
+
+	}
+
+	uint8_t u8()
+	{
+		if (_position >= _size) {
+			_position = _size + 1;
+			return 0;
+		}
+		return _data[_position++];
+	}
+
+	uint16_t u16()
+	{
+		const uint8_t low = u8();
+		return low | static_cast<uint16_t>(u8()) << 8;
+	}
+
+	uint32_t u32()
+	{
+		const uint16_t low = u16();
+		return low | static_cast<uint32_t>(u16()) << 16;
+	}
+
+	bool ok() const
+	{
+		return _position <= _size;
+	}
+
+private:
+	const uint8_t *_data;
+	size_t _size;
+	size_t _position;
+};
+
+inline uint8_t pack(const Snapshot &aSnapshot, uint8_t *aOut)
+{
+	return Writer{aOut}.u32(aSnapshot.uptime).u32(aSnapshot.unixTime).u8(aSnapshot.flags).u8(aSnapshot.lampLevel)
+		.u8(aSnapshot.hydroType).u8(aSnapshot.floodTrips).u16(aSnapshot.errors).u16(aSnapshot.successed)
+		.u32(aSnapshot.loops).u16(aSnapshot.loopMax).u16(aSnapshot.dropped).u16(aSnapshot.ph).u16(aSnapshot.ec)
+		.u16(static_cast<uint16_t>(aSnapshot.temperature)).u16(aSnapshot.stackFree).u16(aSnapshot.heapFree).size();
+}
+
+inline bool unpack(const uint8_t *aData, size_t aSize, Snapshot &aSnapshot)
+{
+	Reader reader{aData, aSize};
+	aSnapshot.uptime = reader.u32();
+	aSnapshot.unixTime = reader.u32();
+	aSnapshot.flags = reader.u8();
+	aSnapshot.lampLevel = reader.u8();
+	aSnapshot.hydroType = reader.u8();
+	aSnapshot.floodTrips = reader.u8();
+	aSnapshot.errors = reader.u16();
+	aSnapshot.successed = reader.u16();
+	aSnapshot.loops = reader.u32();
+	aSnapshot.loopMax = reader.u16();
+	aSnapshot.dropped = reader.u16();
+	aSnapshot.ph = reader.u16();
+	aSnapshot.ec = reader.u16();
+	aSnapshot.temperature = static_cast<int16_t>(reader.u16());
+	aSnapshot.stackFree = reader.u16();
+	aSnapshot.heapFree = reader.u16();
+	return reader.ok();
+}
+
+inline uint8_t pack(const Event &aEvent, uint8_t *aOut)
+{
+	return Writer{aOut}.u32(aEvent.time).u8(aEvent.type).u8(aEvent.argument).size();
+}
+
+inline bool unpack(const uint8_t *aData, size_t aSize, Event &aEvent)
+{
+	Reader reader{aData, aSize};
+	aEvent.time = reader.u32();
+	aEvent.type = reader.u8();
+	aEvent.argument = reader.u8();
+	return reader.ok();
+}
+
+// Собирает кадр в aOut (не меньше kMaxFrameSize) вместе с разделителем, возвращает его длину.
+// Данные длиннее kMaxPayload обрезаются
+inline uint8_t frame(Type aType, uint8_t aSequence, const void *aPayload, uint8_t aSize, uint8_t *aOut)
+{
+	uint8_t raw[kMaxPayload + kOverhead];
+	const uint8_t size = aSize < kMaxPayload ? aSize : kMaxPayload;
+	const uint8_t *payload = static_cast<const uint8_t *>(aPayload);
+
+	raw[0] = static_cast<uint8_t>(aType);
+	raw[1] = aSequence;
+	for (uint8_t i = 0; i < size; ++i) {
+		raw[2 + i] = payload[i];
+	}
+
+	const uint16_t crc = Crc::ccitt(raw, size + 2);
+	raw[size + 2] = static_cast<uint8_t>(crc);
+	raw[size + 3] = static_cast<uint8_t>(crc >> 8);
+
+	const size_t encoded = Cobs::encode(raw, size + kOverhead, aOut);
+	aOut[encoded] = Cobs::kDelimiter;
+	return static_cast<uint8_t>(encoded + 1);
+}
+
+struct Frame {
+	Type type;
+	uint8_t sequence;
+	const uint8_t *payload; // Указывает в буфер, переданный parse()
+	size_t size;
+};
+
+// Разбирает кадр без разделителя. aBuffer не меньше aSize. false - кадр испорчен
+inline bool parse(const uint8_t *aEncoded, size_t aSize, uint8_t *aBuffer, Frame &aFrame)
+{
+	size_t size;
+	if (!Cobs::decode(aEncoded, aSize, aBuffer, size) || size < kOverhead) {
+		return false;
+	}
+
+	const uint16_t crc = aBuffer[size - 2] | static_cast<uint16_t>(aBuffer[size - 1]) << 8;
+	if (Crc::ccitt(aBuffer, size - 2) != crc) {
+		return false;
+	}
+
+	aFrame = Frame{static_cast<Type>(aBuffer[0]), aBuffer[1], aBuffer + 2, size - kOverhead};
+	return true;
+}
+
+} // namespace Telemetry
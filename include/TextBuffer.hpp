@@ -0,0 +1,128 @@
+//
+// TextBuffer.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Строка фиксированной емкости на стеке для вывода на экран, без кучи.
+// Все, что не влезает, молча обрезается
+
+#pragma once
+
+#include "Flash.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+template<size_t Capacity>
+class TextBuffer {
+public:
+	TextBuffer() :
+	_length{0}
+	{
+		_data[0] = '\0';
+	}
+
+	TextBuffer &append(char aChar)
+	{
+		if (_length < Capacity) {
+			_data[_length++] = aChar;
+			_data[_length] = '\0';
+		}
+		return *this;
+	}
+
+	TextBuffer &append(const char *aText)
+	{
+		while (*aText) {
+			append(*aText++);
+		}
+		return *this;
+	}
+
+	// Строка из flash (PSTR, PROGMEM)
+	TextBuffer &appendP(const char *aText)
+	{
+		char symbol;
+		while ((symbol = static_cast<char>(pgm_read_byte(aText++))) != '\0') {
+			append(symbol);
+		}
+		return *this;
+	}
+
+	TextBuffer &appendNumber(uint32_t aValue)
+	{
+		char digits[10];
+		uint8_t count{0};
+
+		do {
+			digits[count++] = static_cast<char>('0' + aValue % 10);
+			aValue /= 10;
+		} while (aValue);
+
+		while (count) {
+			append(digits[--count]);
+		}
+		return *this;
+	}
+
+	// Число с фиксированной точкой: aValue в единицах 10^-aDecimals, например 652 и 2 - "6.52"
+	TextBuffer &appendFixed(int32_t aValue, uint8_t aDecimals)
+	{
+		uint32_t divider{1};
+		for (uint8_t i = 0; i < aDecimals; ++i) {
+			divider *= 10;
+		}
+
+		if (aValue < 0) {
+			append('-');
+		}
+		const uint32_t value = aValue < 0 ? -static_cast<uint32_t>(aValue) : static_cast<uint32_t>(aValue);
+		appendNumber(value / divider);
+
+		if (aDecimals) {
+			append('.');
+			uint32_t fraction = value % divider;
+			while (divider /= 10) {
+				append(static_cast<char>('0' + fraction / divider));
+				fraction %= divider;
+			}
+		}
+		return *this;
+	}
+
+	// Две цифры с ведущим нулем
+	TextBuffer &appendTwoDigits(uint8_t aValue)
+	{
+		append(static_cast<char>('0' + (aValue / 10) % 10));
+		return append(static_cast<char>('0' + aValue % 10));
+	}
+
+	// ЧЧ:ММ
+	TextBuffer &appendTime(uint8_t aHours, uint8_t aMinutes)
+	{
+		appendTwoDigits(aHours);
+		append(':');
+		return appendTwoDigits(aMinutes);
+	}
+
+	void clear()
+	{
+		_length = 0;
+		_data[0] = '\0';
+	}
+
+	const char *c_str() const
+	{
+		return _data;
+	}
+
+	size_t length() const
+	{
+		return _length;
+	}
+
+private:
+	char _data[Capacity + 1];
+	uint8_t _length;
+};
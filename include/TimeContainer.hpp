@@ -5,121 +5,147 @@
 //      Author: V.Nezlo
 //
 
-// Класс для удобной работы со временем
-// Операторы < и > сделаны без учета перехода времени через ноль
-// TODO: Переписать
+// Время суток, хранится одним числом - секундами от полуночи, поэтому сравнение это одна
+// операция над целым. Арифметика идет по кругу суток: 23:30 плюс 90 минут - это 01:00
 
-class TimeContainer {
+#pragma once
 
-private:
-uint8_t _hours;
-uint8_t _minutes;
-uint8_t _seconds;
+#include <stdint.h>
 
+class TimeContainer {
 public:
-	TimeContainer(uint8_t aHour, uint8_t aMinutes, uint8_t aSeconds = 0) :
-	_hours{aHour},
-	_minutes{aMinutes},
-	_seconds{aSeconds}
+	static constexpr uint32_t kSecondsInDay{86400};
+
+	constexpr TimeContainer() :
+	_seconds{0}
+	{
+
+	}
+
+	constexpr TimeContainer(uint8_t aHour, uint8_t aMinutes, uint8_t aSeconds = 0) :
+	_seconds{static_cast<uint32_t>((3600UL * aHour + 60UL * aMinutes + aSeconds) % kSecondsInDay)}
 	{
 
 	}
 
-	bool operator == (const TimeContainer &cont1) const&
+	static constexpr TimeContainer fromSeconds(uint32_t aSeconds)
+	{
+		return TimeContainer{Seconds{}, aSeconds % kSecondsInDay};
+	}
+
+	constexpr bool operator == (const TimeContainer &aOther) const
 	{
-		return ((_hours == cont1._hours) && (_minutes == cont1._minutes) && (_seconds == cont1._seconds));
+		return _seconds == aOther._seconds;
 	}
 
-	bool operator != (const TimeContainer &cont1) const&
+	constexpr bool operator != (const TimeContainer &aOther) const
 	{
-		return ((_hours != cont1._hours) || (_minutes != cont1._minutes) || (_seconds != cont1._seconds));
+		return _seconds != aOther._seconds;
 	}
 
-	bool operator < (const TimeContainer &cont1) const&
+	constexpr bool operator < (const TimeContainer &aOther) const
 	{
-		if (_hours < cont1._hours) {
-			return true;
-		} else if (_hours > cont1._hours) {
-			return false;
-		} else if (_hours == cont1._hours) {
-			if (_minutes < cont1._minutes) {
-				return true;
-			} else if (_minutes > cont1._minutes) {
-				return false;
-			} else if (_minutes == cont1._minutes) {
-				if (_seconds < cont1._seconds) {
-					return true;
-				} else {
-					return false;
-				}
-			}
-		}
-		return false;
+		return _seconds < aOther._seconds;
 	}
 
-	bool operator > (const TimeContainer &cont1) const&
+	constexpr bool operator > (const TimeContainer &aOther) const
 	{
-		if (_hours > cont1._hours) {
-			return true;
-		} else if (_hours < cont1._hours) {
-			return false;
-		} else if (_hours == cont1._hours) {
-			if (_minutes > cont1._minutes) {
-				return true;
-			} else if (_minutes < cont1._minutes) {
-				return false;
-			} else if (_minutes == cont1._minutes) {
-				if (_seconds > cont1._seconds) {
-					return true;
-				} else {
-					return false;
-				}
-			}
-		}
-		return false;
+		return _seconds > aOther._seconds;
 	}
 
 	void setTime(uint8_t aHour, uint8_t aMinutes, uint8_t aSeconds = 0)
 	{
-	    _hours = aHour;
-	    _minutes = aMinutes;
-	    _seconds = aSeconds;
+		*this = TimeContainer{aHour, aMinutes, aSeconds};
 	}
 
-	void getTime(uint8_t &aHours, uint8_t &aMinutes, uint8_t &aSeconds) 
+	void getTime(uint8_t &aHours, uint8_t &aMinutes, uint8_t &aSeconds) const
 	{
-		aHours = _hours;
-		aMinutes = _minutes;
-		aSeconds = _seconds;
+		aHours = hour();
+		aMinutes = minute();
+		aSeconds = seconds();
 	}
 
-	uint8_t hour() const
+	constexpr uint8_t hour() const
 	{
-		return _hours;
+		return _seconds / 3600;
 	}
 
-	uint8_t minute() const
+	constexpr uint8_t minute() const
 	{
-		return _minutes;
+		return (_seconds / 60) % 60;
 	}
 
-	uint8_t seconds() const
+	constexpr uint8_t seconds() const
+	{
+		return _seconds % 60;
+	}
+
+	constexpr uint32_t secondsOfDay() const
 	{
 		return _seconds;
 	}
 
-	void addTime(uint8_t aMinutes)
+	// Сдвиг вперед на любое число минут по кругу суток
+	void addTime(uint16_t aMinutes)
+	{
+		*this = plusSeconds(60UL * aMinutes);
+	}
+
+	constexpr TimeContainer plusSeconds(uint32_t aSeconds) const
 	{
-		uint8_t curMinutes = _minutes;
-		if (curMinutes + aMinutes < 60) {
-			_minutes += aMinutes;
-		} else {
-			_minutes = (curMinutes + aMinutes) - 60;
-			if (_hours < 23) {
-				++_hours;
-			} else {
-				_hours = 0;
-			}
-		}
+		return fromSeconds(_seconds + aSeconds % kSecondsInDay);
 	}
-};
\ No newline at end of file
+
+	// Сколько секунд прошло от aFrom до этого времени, если идти вперед по кругу суток
+	constexpr uint32_t since(const TimeContainer &aFrom) const
+	{
+		return _seconds >= aFrom._seconds ? _seconds - aFrom._seconds : _seconds + kSecondsInDay - aFrom._seconds;
+	}
+
+private:
+	struct Seconds {};
+
+	// Для fromSeconds(): значение уже приведено к суткам
+	constexpr TimeContainer(Seconds, uint32_t aSeconds) :
+	_seconds{aSeconds}
+	{
+
+	}
+
+	uint32_t _seconds;
+};
+
+// Интервал времени суток [begin, end). Может переходить через полночь: 20:00-06:00 - это ночь.
+// Начало и конец, совпадающие друг с другом, дают пустой интервал
+class TimeWindow {
+public:
+	constexpr TimeWindow(const TimeContainer &aBegin, const TimeContainer &aEnd) :
+	_begin{aBegin},
+	_length{aEnd.since(aBegin)}
+	{
+
+	}
+
+	// Время отсчитывается от начала интервала, и интервал через полночь становится обычным
+	constexpr bool contains(const TimeContainer &aTime) const
+	{
+		return aTime.since(_begin) < _length;
+	}
+
+	constexpr uint32_t length() const
+	{
+		return _length;
+	}
+
+	// Секунд от aTime до ближайшей смены contains(), для пустого интервала - сутки
+	constexpr uint32_t untilChange(const TimeContainer &aTime) const
+	{
+		return !_length ? TimeContainer::kSecondsInDay
+			: (contains(aTime) ? _length - aTime.since(_begin)
+			: TimeContainer::kSecondsInDay - aTime.since(_begin));
+	}
+
+private:
+	TimeContainer _begin;
+	uint32_t _length;
+};
@@ -0,0 +1,200 @@
+//
+// TimeService.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Единый источник времени. RTC читается по I2C один раз при старте и затем в фоне раз в kResyncPeriod,
+// между чтениями время считается по секундным меткам SQW DS3231 (прерывание), все подсистемы
+// получают одно и то же значение из RAM. Если метки пропали, время досчитывается по millis
+// и синхронизируется с RTC чаще. Синхронное чтение ограничено kResyncTimeout: если RTC не ответил,
+// время идет по millis от наилучшей оценки (при старте - время сборки, при установке - новое время),
+// а begin() и set() возвращают false, чтобы ядро записало ошибку
+
+#pragma once
+
+#include "Hal.hpp"
+#include "TimeContainer.hpp"
+#include <stdint.h>
+
+class TimeService {
+public:
+	static constexpr uint32_t kSecondsInDay{TimeContainer::kSecondsInDay};
+	static constexpr uint32_t kResyncPeriod{600}; // Секунды
+	static constexpr uint32_t kFallbackResyncPeriod{60}; // Секунды, когда меток SQW нет
+	static constexpr uint32_t kTickTimeout{2000}; // Миллисекунды без метки, после которых SQW считается мертвым
+	static constexpr uint8_t kResyncAttempts{3}; // Попыток синхронного чтения
+	static constexpr uint16_t kResyncTimeout{200}; // Миллисекунды на все попытки синхронного чтения
+	static constexpr uint16_t kRetryDelay{5000}; // Миллисекунды до повтора после неудачного фонового чтения
+
+	// Время суток из unixtime, RTC хранит локальное время
+	static TimeContainer toTimeOfDay(uint32_t aUnixTime)
+	{
+		return TimeContainer::fromSeconds(aUnixTime);
+	}
+
+	// false - RTC не ответил, время идет по millis от времени сборки
+	bool begin()
+	{
+		Hal::rtcTickInit();
+		_lastTicks = Hal::rtcTicks();
+		_lastTickMillis = Hal::millis();
+		_tickAlive = true;
+		return resync(Hal::buildTime());
+	}
+
+	// Вызывается в каждом проходе главного цикла, без обращений к I2C, кроме периодической синхронизации
+	void update()
+	{
+		const uint32_t ticks = Hal::rtcTicks();
+		const uint32_t currentMillis = Hal::millis();
+
+		if (ticks != _lastTicks) {
+			_lastTicks = ticks;
+			_lastTickMillis = currentMillis;
+			_tickAlive = true;
+		} else if (currentMillis - _lastTickMillis > kTickTimeout) {
+			_tickAlive = false;
+		}
+
+		if (_readPending) {
+			uint32_t time;
+			uint32_t readTicks;
+			const Hal::RtcStatus status = Hal::rtcResult(time, readTicks);
+
+			if (status != Hal::RtcStatus::BUSY) {
+				_readPending = false;
+				if (status == Hal::RtcStatus::DONE) {
+					applySync(time, readTicks);
+				} else {
+					// Срок синхронизации уже прошел, без паузы запрос повторялся бы каждый проход
+					_retryWait = true;
+					_failMillis = currentMillis;
+					countFailure();
+				}
+			}
+		}
+		if (_retryWait && currentMillis - _failMillis >= kRetryDelay) {
+			_retryWait = false;
+		}
+
+		const uint32_t elapsed = _tickAlive ? ticks - _syncTicks : (currentMillis - _syncMillis) / 1000;
+		const uint32_t resyncPeriod = _tickAlive ? uint32_t{kResyncPeriod} : uint32_t{kFallbackResyncPeriod};
+
+		// Чтение RTC идет в фоне, до его окончания время продолжает считаться от прошлой синхронизации
+		if (elapsed >= resyncPeriod && !_readPending && !_retryWait) {
+			_readPending = Hal::rtcRequest();
+		}
+		setCached(_syncTime + elapsed);
+	}
+
+	// false - RTC не ответил, время идет по millis от aUnixTime
+	bool set(uint32_t aUnixTime)
+	{
+		Hal::rtcWrite(aUnixTime);
+		return resync(aUnixTime);
+	}
+
+	uint32_t unixTime() const
+	{
+		return _unixTime;
+	}
+
+	const TimeContainer &timeOfDay() const
+	{
+		return _timeOfDay;
+	}
+
+	// Оценка millis() в момент начала секунды aUnixTime, для будильников планировщика
+	uint32_t millisAt(uint32_t aUnixTime) const
+	{
+		return _secondMillis + (aUnixTime - _unixTime) * 1000;
+	}
+
+	bool tickAlive() const
+	{
+		return _tickAlive;
+	}
+
+	// Неудачных чтений RTC с запуска, фоновых и синхронных
+	uint16_t readFailures() const
+	{
+		return _readFailures;
+	}
+
+private:
+	// Синхронное чтение при старте и после установки времени. Если метка пришла во время чтения,
+	// неизвестно, к какой секунде относится прочитанное, тогда чтение повторяется. Ожидание шины
+	// ограничено сроком, после него время идет от aFallback
+	bool resync(uint32_t aFallback)
+	{
+		const uint32_t start = Hal::millis();
+		const auto expired = [start]() { return Hal::millis() - start >= kResyncTimeout; };
+		uint32_t time;
+		uint32_t ticks;
+
+		_readPending = false;
+		for (uint8_t attempt = 0; attempt < kResyncAttempts && !expired(); ++attempt) {
+			bool requested{false};
+			while (!(requested = Hal::rtcRequest()) && !expired()) {}
+			if (!requested) {
+				break;
+			}
+
+			Hal::RtcStatus status;
+			while ((status = Hal::rtcResult(time, ticks)) == Hal::RtcStatus::BUSY && !expired()) {}
+
+			if (status == Hal::RtcStatus::DONE) {
+				applySync(time, ticks);
+				return true;
+			} else if (status == Hal::RtcStatus::BUSY) {
+				// Ответ придет позже и будет разобран в update()
+				_readPending = true;
+				break;
+			}
+		}
+
+		applySync(aFallback, Hal::rtcTicks());
+		countFailure();
+		return false;
+	}
+
+	void applySync(uint32_t aUnixTime, uint32_t aTicks)
+	{
+		_syncTime = aUnixTime;
+		_syncTicks = aTicks;
+		_syncMillis = Hal::millis();
+		setCached(aUnixTime + (_tickAlive ? Hal::rtcTicks() - aTicks : 0));
+	}
+
+	void countFailure()
+	{
+		if (_readFailures < UINT16_MAX) {
+			++_readFailures;
+		}
+	}
+
+	void setCached(uint32_t aUnixTime)
+	{
+		if (aUnixTime != _unixTime) {
+			_unixTime = aUnixTime;
+			_secondMillis = Hal::millis();
+			_timeOfDay = toTimeOfDay(aUnixTime);
+		}
+	}
+
+	uint32_t _syncTime{0};
+	uint32_t _syncTicks{0};
+	uint32_t _syncMillis{0};
+	uint32_t _lastTicks{0};
+	uint32_t _lastTickMillis{0};
+	uint32_t _unixTime{0};
+	uint32_t _secondMillis{0}; // millis() на момент смены _unixTime
+	uint32_t _failMillis{0}; // millis() неудачного фонового чтения
+	uint16_t _readFailures{0};
+	TimeContainer _timeOfDay;
+	bool _tickAlive{false};
+	bool _readPending{false};
+	bool _retryWait{false}; // После неудачного чтения новый запрос ждет kRetryDelay
+};
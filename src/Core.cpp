@@ -0,0 +1,1690 @@
+/*
+Автор - V-Nezlo
+email: vlladimirka@gmail.com
+Дата создания проекта - 10.12.2021
+*/
+
+#include "Core.hpp"
+#include "BenchMarkers.hpp"
+#include "Board.hpp"
+#include "EventLog.hpp"
+#include "Flash.hpp"
+#include "Hal.hpp"
+#include "Hash.hpp"
+#include "LampDimmer.hpp"
+#include "LightSchedule.hpp"
+#include "LogEvents.hpp"
+#include "Menu.hpp"
+#include "OutputBank.hpp"
+#include "Profiler.hpp"
+#include "PumpPhase.hpp"
+#include "Scheduler.hpp"
+#include "Settings.hpp"
+#include "SignalFilter.hpp"
+#include "Telemetry.hpp"
+#include "TimeContainer.hpp"
+#include "TimeService.hpp"
+#include "TextBuffer.hpp"
+#include <string.h>
+
+enum class DisplayModes : uint8_t {
+	TIME,
+	PH_PPM,
+	PUMP_TIMINGS,
+	LAMP_TIMINGS,
+	STATUS,
+	SET_CUR_TIME,
+	SET_LAMP_PERIOD,
+	SET_PUMP_TIME,
+	SET_SWING_PERIOD,
+	SET_WORKMODE,
+	ERROR_NOFLOATLEV,
+	SET_MAXFLOODTIME,
+	SET_SUNRISE_TIME,
+	SET_SUNSET_TIME,
+	SET_PH_CALIBRATION,
+	SET_EC_CALIBRATION,
+	PUMP_LOCKED,
+	COUNT
+} displayMode;
+
+// Порядок совпадает с порядком выводов в outputs
+enum class Periphs : uint8_t {
+	PUMP,
+	LAMP,
+	REDLED,
+	BLUELED,
+	GREENLED,
+	ZUMMER
+};
+
+enum class ErrorTypes {
+	WARNING, // Предупреждение
+	ERROR, // Ошибка, нужно произвести какие то действия чтобы продолжить
+	CRITICAL // Критическая ошибка, насос блокируется до сброса с экрана
+};
+
+// Задачи планировщика, номера совпадают с порядком регистрации в coreSetup()
+enum class Tasks : uint8_t {
+	DISPLAY,
+	PUMP,
+	LAMP,
+	INDICATION,
+	REPORT,
+	LOG,
+	TELEMETRY,
+	SENSORS,
+	MEMORY,
+	SETTINGS,
+	COUNT
+};
+
+// Участки главного цикла под профилировщиком
+enum class ProfileSections : uint8_t {
+	LOOP, // Проход целиком: события энкодера и поплавка ждут не дольше одного прохода
+	TIME,
+	ENCODER,
+	DISPLAY,
+	PUMP,
+	COUNT
+};
+
+// Медиана выкидывает одиночные выбросы, сглаживание после нее - шум
+struct SensorFilter {
+	MedianFilter<5> median;
+	IirFilter<3> smooth;
+};
+
+struct Statistics {
+	uint16_t successed; // Циклов залива, в которых камера заполнилась
+	uint16_t errors; // Ошибок
+};
+
+static const char kSWVersion[] PROGMEM = "0.7"; // Текущая версия прошивки
+static const char kResetCauseNames[][4] PROGMEM = {"?", "pwr", "ext", "bod", "wdt"}; // По Hal::ResetCause
+static constexpr unsigned long kDisplayUpdateTime{300}; // Время обновления информации на экране
+static constexpr uint8_t kFloatDebounceTime{20}; // Миллисекунды покоя поплавка, после которых уровень принимается
+static constexpr unsigned long kMinWakeDelay{10}; // Повтор задачи, проснувшейся раньше смены секунды
+static constexpr unsigned long kMaxIdleTime{60000}; // Предел coreNextDeadline(), если задачи выходов не запланированы
+static constexpr unsigned long kReportTime{600000}; // Период вывода статистики планировщика
+static constexpr unsigned long kReportLinePeriod{10}; // Строка статистики за проход, чтобы не переполнять буфер порта
+static constexpr unsigned long kTelemetryPeriod{1000}; // Период снимков состояния в телеметрию
+static constexpr unsigned long kSensorPeriod{250}; // Разбор очереди АЦП, значений за это время приходит около десятка
+static constexpr unsigned long kMemoryCheckPeriod{10000}; // Поиск нетронутой метки над кучей
+static constexpr unsigned long kStatisticsSavePeriod{3600000}; // Счетчики статистики пишутся в EEPROM не чаще раза в час
+static constexpr uint16_t kMinStackFree{128}; // Запас ОЗУ, ниже которого предупреждение
+static constexpr unsigned long kLogDumpPeriod{5}; // Запись журнала в порт за проход, строка уходит быстрее
+static constexpr char kLogDumpCommand{'l'}; // Команда по порту: выгрузить журнал
+static constexpr char kReportCommand{'r'}; // Команда по порту: выгрузить статистику сейчас
+static constexpr unsigned long kDisplayRedrawTime{60000}; // Период полной перерисовки экрана с настройкой контроллера, даже если ничего не изменилось
+static constexpr uint8_t kMaxPumpPeriod{60}; // Максимальная длительность периода залива-отлива в минутах
+static constexpr uint8_t kMaxSwingPeriod{30}; // Максимальный период раскачивания в секундах
+static constexpr uint16_t kMaxTimeForFlood{300}; // Максимально настраиваемое время заполнения камеры в секундах
+static constexpr uint8_t kMaxRampTime{60}; // Максимальная длительность рассвета и заката в минутах
+static constexpr int16_t kMaxPh{1400}; // pH в сотых
+static constexpr int16_t kMaxEc{30000}; // Проводимость калибровочного раствора, мкСм/см
+static constexpr uint8_t kEcCalibrationStep{10}; // Шаг настройки проводимости, мкСм/см
+static constexpr uint16_t kErrorBlinkingPeriod{500}; // Миллисекунды
+static constexpr uint8_t kErrorCleanPeriod{1}; // Время, по прошествии которого ошибка сбросится сама в минутах 
+static constexpr uint8_t kEncoderFastTime{30}; // Шаги энкодера чаще этого (мс) - быстрое вращение
+static constexpr uint8_t kEncoderFastStep{10}; // Шаг настройки при быстром вращении
+static constexpr uint8_t kEncoderMediumTime{80};
+static constexpr uint8_t kEncoderMediumStep{3};
+static constexpr uint8_t kProfileSections{static_cast<uint8_t>(ProfileSections::COUNT)};
+// Бюджеты участков в микросекундах, проход дольше считается превышением
+static const uint16_t kProfileBudgets[kProfileSections] PROGMEM = {10000, 2000, 2000, 5000, 2000};
+#ifdef PROFILER
+static const char kProfileNames[kProfileSections][8] PROGMEM = {"loop", "time", "encoder", "display", "pump"};
+#endif
+// Строка сводки и строка гистограммы на участок
+static constexpr uint8_t kProfileReportLines{Profiler::kEnabled ? 2 * kProfileSections : 0};
+static constexpr uint8_t kStatusPages{2 + (Profiler::kEnabled ? kProfileSections : 0)}; // Версия, память, участки
+
+TimeService timeService;
+Scheduler<static_cast<uint8_t>(Tasks::COUNT)> scheduler;
+OutputBank<PumpPin, LampPin, RedLedPin, BlueLedPin, GreenLedPin, ZummerPin> outputs;
+HydroTypes hydroType;
+uint32_t pumpEpoch{PumpPhase::kNoEpoch}; // Начало первого цикла залив-отлив
+uint32_t pumpNextCheckTime{0};
+uint32_t pumpNextSwingTime{0};
+
+LightPeriod lampPeriods[kLightPeriods];
+LightSchedule<kLightPeriods> lightSchedule;
+uint8_t lampPeriod{0}; // Период света, который сейчас настраивается
+uint8_t menuField{0}; // Активное поле экрана настройки
+uint8_t editBuffer[4]; // Копии значений, которые применяются функцией, а не записью в переменную
+bool currentTimeChanged{false}; // Время суток крутили: в RTC оно запишется один раз при уходе с экрана
+uint8_t sunriseTime{0}; // Рассвет и закат в минутах, 0 - лампа включается и выключается сразу
+uint8_t sunsetTime{0};
+uint8_t lampLevel{0}; // Уровень яркости, записанный в ШИМ
+
+uint8_t swingOffPeriod{0}; // Время состояния "качелей" выключено в секундах
+uint8_t pumpOnPeriod{0};
+uint8_t pumpOffPeriod{0};
+uint16_t maxTimeForFullFlood{0};
+uint32_t lastRedrawTime{0}; // Время последней полной перерисовки экрана
+uint32_t screenKey{0}; // Ключ содержимого экрана на момент последней отрисовки
+uint32_t nextErrorCleanTime{0}; // Время следующего сброса ошибки
+uint32_t lastErrorTime{0}; // Время последней ошибки
+
+SettingsStore settingsStore;
+using Log = EventLog<kLogAddress, kLogSize>;
+Log eventLog;
+Log::Cursor logCursor; // Позиция выгрузки журнала в порт
+uint8_t floodTrips{0}; // Заполнений камеры за текущий залив
+uint8_t reportLine{0}; // Следующая строка статистики планировщика
+uint32_t loopCount{0}; // Проходов цикла с прошлого снимка телеметрии
+uint16_t loopMaxTime{0}; // Самый долгий проход с прошлого снимка, микросекунды
+LoopProfiler<kProfileSections> profiler{kProfileBudgets};
+uint8_t statusPage{0}; // Страница экрана STATUS: 0 - версия, 1 - память, дальше участки профилировщика
+Hal::MemoryStatus memory{UINT16_MAX, 0, 0, 0}; // Последний замер ОЗУ
+
+SensorFilter sensorFilters[static_cast<uint8_t>(Hal::AdcChannel::COUNT)];
+ProbeCalibration phCalibration{Probe::kPhDefault};
+ProbeCalibration ecCalibration{Probe::kEcDefault};
+ProbeCalibration calibrationDraft; // Калибровка, которая сейчас снимается, применяется после последней точки
+uint8_t calibrationPoint{0};
+int16_t calibrationValue{0}; // Значение раствора в текущей точке, для проводимости - при 25 градусах
+bool calibrationChanged{false}; // Значение крутили: нажатие запомнит точку, иначе пропустит
+
+uint16_t currentPH{0}; // Сотые
+uint16_t currentEC{0}; // мкСм/см, приведенная к 25 градусам
+uint16_t currentPPM{0}; // Шкала 500: ppm = EC / 2
+int16_t currentTemperature{Probe::kNoTemperature}; // Десятые градуса
+
+bool swingState{false};
+bool pumpState{false};
+bool lampState{false};
+bool modeConf{false};
+bool errorState{false};
+bool errorStatePos{false};
+bool pumpLocked{false}; // После критической ошибки насос не включается, пока блокировку не снимут с экрана
+
+// Флаги для разных проверок
+bool pumpCheckNeeded{false};
+Statistics statistics{0,0};
+//
+
+void eepromWrite();
+void eepromRead();
+
+constexpr uint8_t toScreen(DisplayModes aMode)
+{
+	return static_cast<uint8_t>(aMode);
+}
+
+// Событие только в телеметрию
+void sendEvent(LogEvents aEvent, uint8_t aArgument = 0)
+{
+	uint8_t payload[Telemetry::kEventSize];
+	const Telemetry::Event event{timeService.unixTime(), static_cast<uint8_t>(aEvent), aArgument};
+	Hal::telemetry(Telemetry::Type::EVENT, payload, Telemetry::pack(event, payload));
+}
+
+// Событие в журнал EEPROM и в телеметрию
+void logEvent(LogEvents aEvent, uint8_t aArgument = 0)
+{
+	eventLog.append(static_cast<uint8_t>(aEvent), aArgument, timeService.unixTime());
+	sendEvent(aEvent, aArgument);
+}
+
+void profile(ProfileSections aSection, uint32_t aStart)
+{
+	profiler.stop(static_cast<uint8_t>(aSection), aStart);
+}
+
+// Запуск задачи через aDelay миллисекунд
+void wake(Tasks aTask, uint32_t aDelay = 0)
+{
+	scheduler.schedule(static_cast<uint8_t>(aTask), Hal::millis() + aDelay);
+}
+
+// Запуск задачи в начале секунды aUnixTime
+void wakeAt(Tasks aTask, uint32_t aUnixTime)
+{
+	const uint32_t currentMillis = Hal::millis();
+	uint32_t deadline = timeService.millisAt(aUnixTime);
+
+	if (static_cast<int32_t>(deadline - currentMillis) < static_cast<int32_t>(kMinWakeDelay)) {
+		deadline = currentMillis + kMinWakeDelay; // Секундная метка запаздывает, проверим чуть позже
+	}
+	scheduler.schedule(static_cast<uint8_t>(aTask), deadline);
+}
+
+// Настройки или время изменились, задачи по времени пересчитают свои сроки
+void wakeTimeTasks()
+{
+	lightSchedule.build(lampPeriods);
+	wake(Tasks::PUMP);
+	wake(Tasks::LAMP);
+}
+
+void pinInit()
+{
+	RedLedPin::init();
+	BlueLedPin::init();
+	GreenLedPin::init();
+	PumpPin::init();
+	LampPin::init();
+	ZummerPin::init();
+	Hal::lampPwmInit();
+	Hal::floatInit(kFloatDebounceTime);
+	Hal::adcInit();
+
+	Hal::encoderInit();
+}
+
+PumpPhase::Phase pumpPhase(uint32_t aUnixTime)
+{
+	return PumpPhase::at(aUnixTime, pumpEpoch, 60UL * pumpOnPeriod, 60UL * pumpOffPeriod);
+}
+
+// Новые длительности насоса. Текущая фаза сохраняет свое начало, меняется только ее длина
+void setPumpPeriods(uint8_t aOnPeriod, uint8_t aOffPeriod)
+{
+	const PumpPhase::Phase phase = pumpPhase(timeService.unixTime());
+
+	pumpOnPeriod = aOnPeriod;
+	pumpOffPeriod = aOffPeriod;
+	pumpEpoch = PumpPhase::anchor(phase, 60UL * pumpOnPeriod);
+}
+
+// Меняет часы и минуты в RTC, сохраняя дату и секунды. false - RTC не ответил
+bool setTimeOfDay(uint8_t aHour, uint8_t aMinute)
+{
+	const uint32_t unixTime = timeService.unixTime();
+	const uint32_t dayStart = unixTime - (unixTime % TimeService::kSecondsInDay);
+	if (!timeService.set(dayStart + 3600UL * aHour + 60UL * aMinute + timeService.timeOfDay().seconds())) {
+		logEvent(LogEvents::RTC_FAILED);
+		return false;
+	}
+	return true;
+}
+
+// Отфильтрованный отсчет канала АЦП
+uint16_t sensorRaw(Hal::AdcChannel aChannel)
+{
+	return sensorFilters[static_cast<uint8_t>(aChannel)].smooth.value();
+}
+
+// Калибровка снимается по точкам: значение раствора настраивается энкодером, нажатие запоминает
+// текущий отсчет датчика. Нажатие без настройки оставляет точку прежней
+DisplayModes beginCalibration(DisplayModes aMode)
+{
+	calibrationDraft = aMode == DisplayModes::SET_PH_CALIBRATION ? phCalibration : ecCalibration;
+	calibrationPoint = 0;
+	calibrationValue = calibrationDraft.value[0];
+	calibrationChanged = false;
+	return aMode;
+}
+
+// Следующий экран после нажатия на экране калибровки
+DisplayModes nextCalibrationPoint()
+{
+	const bool ph = displayMode == DisplayModes::SET_PH_CALIBRATION;
+
+	if (calibrationChanged) {
+		// Раствор проводимости при другой температуре проводит иначе, точка запоминается в пересчете
+		calibrationDraft.raw[calibrationPoint] = sensorRaw(ph ? Hal::AdcChannel::PH : Hal::AdcChannel::EC);
+		const int32_t value = ph ? calibrationValue : Probe::uncompensateEc(calibrationValue, currentTemperature);
+		calibrationDraft.value[calibrationPoint] = static_cast<int16_t>(value < INT16_MAX ? value : INT16_MAX);
+	}
+
+	if (calibrationPoint == 0) {
+		calibrationPoint = 1;
+		calibrationValue = calibrationDraft.value[1];
+		calibrationChanged = false;
+		return displayMode;
+	}
+
+	if (Probe::valid(calibrationDraft)) {
+		(ph ? phCalibration : ecCalibration) = calibrationDraft;
+	}
+
+	if (ph) {
+		return beginCalibration(DisplayModes::SET_EC_CALIBRATION);
+	}
+	return DisplayModes::SET_CUR_TIME;
+}
+
+// Шаг настройки по скорости вращения энкодера, чтобы большие диапазоны проходились быстро
+uint8_t encoderStep(uint8_t aInterval)
+{
+	if (aInterval < kEncoderFastTime) {
+		return kEncoderFastStep;
+	} else if (aInterval < kEncoderMediumTime) {
+		return kEncoderMediumStep;
+	}
+	return 1;
+}
+
+// Название режима, строка во flash
+const char *getHydroTypeName()
+{
+	switch (hydroType) {
+		case HydroTypes::NORMAL:
+			return PSTR("Normal");
+		case HydroTypes::SWING:
+			return PSTR("Normal-swing");
+	}
+	return PSTR("Unknown");
+}
+
+uint8_t lampPeriodsEnabled()
+{
+	uint8_t count{0};
+	for (const auto &period : lampPeriods) {
+		count += period.on != period.off;
+	}
+	return count;
+}
+
+// Обработчики экранов меню: то, что не описывается полями таблицы
+
+void renderTime(Menu::Line &, Menu::Line &aLine2)
+{
+	const TimeContainer &now{timeService.timeOfDay()};
+	aLine2.appendTime(now.hour(), now.minute());
+}
+
+void renderSensors(Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	aLine1.appendP(PSTR("pH ")).appendFixed(currentPH, 2).appendP(PSTR("  t "));
+	if (currentTemperature != Probe::kNoTemperature) {
+		aLine1.appendFixed(currentTemperature, 1).append('C');
+	} else {
+		aLine1.appendP(PSTR("--"));
+	}
+	aLine2.appendP(PSTR("EC ")).appendNumber(currentEC).appendP(PSTR("uS ")).appendNumber(currentPPM);
+	aLine2.appendP(PSTR("ppm"));
+}
+
+void renderPumpTimings(Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	aLine1.appendP(PSTR("Flood = ")).appendNumber(pumpOnPeriod);
+	aLine2.appendP(PSTR("Drain = ")).appendNumber(pumpOffPeriod);
+}
+
+void renderLampTimings(Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	const TimeContainer change = TimeService::toTimeOfDay(lightSchedule.nextChange());
+
+	aLine1.appendNumber(lampPeriodsEnabled());
+	if (lightSchedule.events()) {
+		aLine2.appendP(lampState ? PSTR("On till ") : PSTR("Off till ")).appendTime(change.hour(), change.minute());
+		aLine2.append(' ').appendNumber(lampLevel * 100U / LampDimmer::kMaxLevel).append('%');
+	} else {
+		aLine2.appendP(PSTR("Always off"));
+	}
+}
+
+#ifdef PROFILER
+// Среднее и максимум в микросекундах, гистограмма цифрами 0..9 пропорционально корзинам и превышения
+void renderProfile(uint8_t aSection, Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	const Profiler::Stats &stats = profiler.stats(aSection);
+	uint32_t total{0};
+	for (const auto count : stats.histogram) {
+		total += count;
+	}
+
+	aLine1.appendP(kProfileNames[aSection]).append(' ');
+	aLine1.appendNumber(Profiler::toMicros(stats.count ? stats.total / stats.count : 0)).append('/');
+	aLine1.appendNumber(Profiler::toMicros(stats.max)).appendP(PSTR("us"));
+
+	aLine2.appendP(PSTR("h "));
+	for (const auto count : stats.histogram) {
+		// Непустая корзина не меньше 1, чтобы редкие долгие проходы были видны
+		aLine2.append(static_cast<char>('0' + (count ? 1 + static_cast<uint32_t>(count) * 8 / total : 0)));
+	}
+	aLine2.appendP(PSTR(" ovr ")).appendNumber(stats.overruns);
+}
+#endif
+
+void renderStatus(Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	switch (statusPage) {
+		case 0:
+			aLine1.appendP(PSTR("Ver: ")).appendP(kSWVersion);
+			aLine1.appendP(PSTR(" rst ")).appendP(kResetCauseNames[static_cast<uint8_t>(Hal::resetCause())]);
+			aLine2.appendP(PSTR("Errors: ")).appendNumber(statistics.errors);
+			break;
+		case 1:
+			aLine1.appendP(PSTR("Stack min ")).appendNumber(memory.stackFree).appendP(PSTR(" B"));
+			aLine2.appendP(PSTR("Free ")).appendNumber(memory.free).appendP(PSTR(" frag ")).appendNumber(memory.heapFree);
+			break;
+		default:
+#ifdef PROFILER
+			renderProfile(statusPage - 2, aLine1, aLine2);
+#endif
+			break;
+	}
+}
+
+// Нажатие листает страницы: память и статистику профилировщика
+uint8_t leaveStatus()
+{
+	if (++statusPage >= kStatusPages) {
+		statusPage = 0;
+	}
+	return toScreen(DisplayModes::STATUS);
+}
+
+void renderFloatError(Menu::Line &, Menu::Line &aLine2)
+{
+	aLine2.appendP(PSTR("Plug float level"));
+}
+
+void renderPumpLocked(Menu::Line &, Menu::Line &aLine2)
+{
+	aLine2.appendP(PSTR("Press to clear"));
+}
+
+uint8_t unlockPump();
+
+// Время суток правится копией: пока его не трогали, копия идет за часами. Шаги энкодера меняют
+// только копию, запись в RTC с пересинхронизацией одна - при уходе с экрана
+void loadCurrentTime()
+{
+	if (currentTimeChanged) {
+		return;
+	}
+
+	const TimeContainer &now{timeService.timeOfDay()};
+	editBuffer[0] = now.hour();
+	editBuffer[1] = now.minute();
+}
+
+void applyCurrentTime()
+{
+	currentTimeChanged = true;
+}
+
+void commitCurrentTime()
+{
+	if (currentTimeChanged) {
+		currentTimeChanged = false;
+		if (setTimeOfDay(editBuffer[0], editBuffer[1])) {
+			wakeTimeTasks(); // Сроки насоса и лампы посчитаны по старому времени
+		}
+	}
+}
+
+uint8_t leaveCurrentTime()
+{
+	commitCurrentTime();
+	lampPeriod = 0;
+	return toScreen(DisplayModes::SET_LAMP_PERIOD);
+}
+
+void loadLampPeriod()
+{
+	const LightPeriod &period = lampPeriods[lampPeriod];
+	editBuffer[0] = period.on.hour();
+	editBuffer[1] = period.on.minute();
+	editBuffer[2] = period.off.hour();
+	editBuffer[3] = period.off.minute();
+}
+
+// Период может переходить через полночь, поэтому включение и выключение не упорядочиваются
+void applyLampPeriod()
+{
+	lampPeriods[lampPeriod] = LightPeriod{TimeContainer{editBuffer[0], editBuffer[1]},
+		TimeContainer{editBuffer[2], editBuffer[3]}};
+}
+
+// Периоды настраиваются по очереди, ненужный выключается совпадением времен
+uint8_t leaveLampPeriod()
+{
+	if (++lampPeriod < kLightPeriods) {
+		return toScreen(DisplayModes::SET_LAMP_PERIOD);
+	}
+	return toScreen(DisplayModes::SET_SUNRISE_TIME);
+}
+
+void renderLampPeriod(Menu::Line &aLine1, Menu::Line &)
+{
+	aLine1.appendNumber(lampPeriod + 1);
+}
+
+// Длительности насоса меняются вместе с эпохой, запись прямо в переменные сдвинула бы фазу
+void loadPumpPeriods()
+{
+	editBuffer[0] = pumpOnPeriod;
+	editBuffer[1] = pumpOffPeriod;
+}
+
+void applyPumpPeriods()
+{
+	setPumpPeriods(editBuffer[0], editBuffer[1]);
+}
+
+void loadWorkMode()
+{
+	editBuffer[0] = static_cast<uint8_t>(hydroType);
+}
+
+void applyWorkMode()
+{
+	hydroType = static_cast<HydroTypes>(editBuffer[0]);
+}
+
+uint8_t leaveWorkMode()
+{
+	if (hydroType == HydroTypes::SWING) {
+		return toScreen(DisplayModes::SET_SWING_PERIOD);
+	}
+	return toScreen(beginCalibration(DisplayModes::SET_PH_CALIBRATION));
+}
+
+void renderWorkMode(Menu::Line &, Menu::Line &aLine2)
+{
+	aLine2.appendP(getHydroTypeName());
+}
+
+uint8_t leaveSwingPeriod()
+{
+	return toScreen(beginCalibration(DisplayModes::SET_PH_CALIBRATION));
+}
+
+void changeCalibration()
+{
+	calibrationChanged = true;
+}
+
+uint8_t leaveCalibration()
+{
+	return toScreen(nextCalibrationPoint());
+}
+
+void renderPhCalibration(Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	aLine1.appendNumber(calibrationPoint + 1).appendP(PSTR(" now ")).appendFixed(currentPH, 2);
+	aLine2.appendP(PSTR(" raw ")).appendNumber(sensorRaw(Hal::AdcChannel::PH));
+}
+
+void renderEcCalibration(Menu::Line &aLine1, Menu::Line &aLine2)
+{
+	aLine1.appendNumber(calibrationPoint + 1).appendP(PSTR(" now ")).appendNumber(currentEC);
+	aLine2.appendP(PSTR("uS raw ")).appendNumber(sensorRaw(Hal::AdcChannel::EC));
+}
+
+static const char kTitleTime[] PROGMEM = "Current time";
+static const char kTitleLampTimings[] PROGMEM = "Lamp periods: ";
+static const char kTitleSetTime[] PROGMEM = "Set Cur time";
+static const char kTitleLampPeriod[] PROGMEM = "Lamp period ";
+static const char kTitlePumpTime[] PROGMEM = "Flood / Drain, min";
+static const char kTitleSwingPeriod[] PROGMEM = "Swing period, s";
+static const char kTitleWorkMode[] PROGMEM = "Work Mode is:";
+static const char kTitleFloatError[] PROGMEM = "Float level error";
+static const char kTitlePumpLocked[] PROGMEM = "Pump locked";
+static const char kTitleMaxFloodTime[] PROGMEM = "Max flood time, s";
+static const char kTitleSunrise[] PROGMEM = "Sunrise, min";
+static const char kTitleSunset[] PROGMEM = "Sunset, min";
+static const char kTitlePhCalibration[] PROGMEM = "pH point ";
+static const char kTitleEcCalibration[] PROGMEM = "EC point ";
+static const char kLabelColon[] PROGMEM = ":";
+static const char kLabelDash[] PROGMEM = " - ";
+static const char kLabelSlash[] PROGMEM = " / ";
+
+// Поля экранов настройки, каждый экран ссылается на свои подряд идущие записи
+static const Menu::Field kFields[] PROGMEM = {
+	// SET_CUR_TIME: 0
+	{&editBuffer[0], Menu::ValueType::U8, Menu::Format::TWO_DIGITS, 0, 23, 1, nullptr},
+	{&editBuffer[1], Menu::ValueType::U8, Menu::Format::TWO_DIGITS, 0, 59, 1, kLabelColon},
+	// SET_LAMP_PERIOD: 2
+	{&editBuffer[0], Menu::ValueType::U8, Menu::Format::TWO_DIGITS, 0, 23, 1, nullptr},
+	{&editBuffer[1], Menu::ValueType::U8, Menu::Format::TWO_DIGITS, 0, 59, 1, kLabelColon},
+	{&editBuffer[2], Menu::ValueType::U8, Menu::Format::TWO_DIGITS, 0, 23, 1, kLabelDash},
+	{&editBuffer[3], Menu::ValueType::U8, Menu::Format::TWO_DIGITS, 0, 59, 1, kLabelColon},
+	// SET_PUMP_TIME: 6
+	{&editBuffer[0], Menu::ValueType::U8, Menu::Format::NUMBER, 1, kMaxPumpPeriod, 1, nullptr},
+	{&editBuffer[1], Menu::ValueType::U8, Menu::Format::NUMBER, 1, kMaxPumpPeriod, 1, kLabelSlash},
+	// SET_SWING_PERIOD: 8
+	{&swingOffPeriod, Menu::ValueType::U8, Menu::Format::NUMBER, 1, kMaxSwingPeriod, 1, nullptr},
+	// SET_WORKMODE: 9
+	{&editBuffer[0], Menu::ValueType::U8, Menu::Format::HIDDEN, 0, static_cast<int16_t>(HydroTypes::SWING), 1, nullptr},
+	// SET_MAXFLOODTIME: 10
+	{&maxTimeForFullFlood, Menu::ValueType::U16, Menu::Format::NUMBER, 10, kMaxTimeForFlood, 1, nullptr},
+	// SET_SUNRISE_TIME: 11
+	{&sunriseTime, Menu::ValueType::U8, Menu::Format::NUMBER, 0, kMaxRampTime, 1, nullptr},
+	// SET_SUNSET_TIME: 12
+	{&sunsetTime, Menu::ValueType::U8, Menu::Format::NUMBER, 0, kMaxRampTime, 1, nullptr},
+	// SET_PH_CALIBRATION: 13
+	{&calibrationValue, Menu::ValueType::I16, Menu::Format::FIXED2, 0, kMaxPh, 1, nullptr},
+	// SET_EC_CALIBRATION: 14
+	{&calibrationValue, Menu::ValueType::I16, Menu::Format::NUMBER, 0, kMaxEc, kEcCalibrationStep, nullptr}
+};
+
+// Экраны в порядке DisplayModes. Экраны просмотра листаются по left и right, нажатие на них
+// вызывает только leave. На экранах настройки поворот меняет активное поле, нажатие переходит
+// к следующему полю и затем к экрану next
+static const Menu::Screen kScreens[] PROGMEM = {
+	// TIME
+	{kTitleTime, toScreen(DisplayModes::STATUS), toScreen(DisplayModes::PH_PPM), Menu::kNone, 0, 0, 60,
+		nullptr, nullptr, nullptr, renderTime},
+	// PH_PPM
+	{nullptr, toScreen(DisplayModes::TIME), toScreen(DisplayModes::PUMP_TIMINGS), Menu::kNone, 0, 0, 0,
+		nullptr, nullptr, nullptr, renderSensors},
+	// PUMP_TIMINGS
+	{nullptr, toScreen(DisplayModes::PH_PPM), toScreen(DisplayModes::LAMP_TIMINGS), Menu::kNone, 0, 0, 0,
+		nullptr, nullptr, nullptr, renderPumpTimings},
+	// LAMP_TIMINGS
+	{kTitleLampTimings, toScreen(DisplayModes::PUMP_TIMINGS), toScreen(DisplayModes::STATUS), Menu::kNone, 0, 0, 0,
+		nullptr, nullptr, nullptr, renderLampTimings},
+	// STATUS
+	{nullptr, toScreen(DisplayModes::LAMP_TIMINGS), toScreen(DisplayModes::TIME), Menu::kNone, 0, 0, 0,
+		nullptr, nullptr, leaveStatus, renderStatus},
+	// SET_CUR_TIME
+	{kTitleSetTime, Menu::kNone, Menu::kNone, Menu::kNone, 0, 2, 60,
+		loadCurrentTime, applyCurrentTime, leaveCurrentTime, nullptr},
+	// SET_LAMP_PERIOD
+	{kTitleLampPeriod, Menu::kNone, Menu::kNone, Menu::kNone, 2, 4, 24,
+		loadLampPeriod, applyLampPeriod, leaveLampPeriod, renderLampPeriod},
+	// SET_PUMP_TIME
+	{kTitlePumpTime, Menu::kNone, Menu::kNone, toScreen(DisplayModes::SET_MAXFLOODTIME), 6, 2, 0,
+		loadPumpPeriods, applyPumpPeriods, nullptr, nullptr},
+	// SET_SWING_PERIOD
+	{kTitleSwingPeriod, Menu::kNone, Menu::kNone, Menu::kNone, 8, 1, 0,
+		nullptr, nullptr, leaveSwingPeriod, nullptr},
+	// SET_WORKMODE
+	{kTitleWorkMode, Menu::kNone, Menu::kNone, Menu::kNone, 9, 1, 0,
+		loadWorkMode, applyWorkMode, leaveWorkMode, renderWorkMode},
+	// ERROR_NOFLOATLEV: несбрасываемая ошибка, листать некуда
+	{kTitleFloatError, toScreen(DisplayModes::ERROR_NOFLOATLEV), toScreen(DisplayModes::ERROR_NOFLOATLEV), Menu::kNone,
+		0, 0, 0, nullptr, nullptr, nullptr, renderFloatError},
+	// SET_MAXFLOODTIME
+	{kTitleMaxFloodTime, Menu::kNone, Menu::kNone, toScreen(DisplayModes::SET_WORKMODE), 10, 1, 0,
+		nullptr, nullptr, nullptr, nullptr},
+	// SET_SUNRISE_TIME
+	{kTitleSunrise, Menu::kNone, Menu::kNone, toScreen(DisplayModes::SET_SUNSET_TIME), 11, 1, 0,
+		nullptr, nullptr, nullptr, nullptr},
+	// SET_SUNSET_TIME
+	{kTitleSunset, Menu::kNone, Menu::kNone, toScreen(DisplayModes::SET_PUMP_TIME), 12, 1, 0,
+		nullptr, nullptr, nullptr, nullptr},
+	// SET_PH_CALIBRATION
+	{kTitlePhCalibration, Menu::kNone, Menu::kNone, Menu::kNone, 13, 1, 0,
+		nullptr, changeCalibration, leaveCalibration, renderPhCalibration},
+	// SET_EC_CALIBRATION
+	{kTitleEcCalibration, Menu::kNone, Menu::kNone, Menu::kNone, 14, 1, 0,
+		nullptr, changeCalibration, leaveCalibration, renderEcCalibration},
+	// PUMP_LOCKED: листать некуда, нажатие снимает блокировку
+	{kTitlePumpLocked, toScreen(DisplayModes::PUMP_LOCKED), toScreen(DisplayModes::PUMP_LOCKED), Menu::kNone,
+		0, 0, 0, nullptr, nullptr, unlockPump, renderPumpLocked}
+};
+
+static_assert(sizeof(kScreens) / sizeof(kScreens[0]) == toScreen(DisplayModes::COUNT), "Screen table mismatch");
+
+Menu::Screen currentScreen()
+{
+	return Menu::read(&kScreens[toScreen(displayMode)]);
+}
+
+Menu::Field screenField(const Menu::Screen &aScreen, uint8_t aIndex)
+{
+	return Menu::read(&kFields[aScreen.firstField + aIndex]);
+}
+
+// Переход на экран, настройка начинается с первого поля
+void showScreen(uint8_t aScreen)
+{
+	if (aScreen < toScreen(DisplayModes::COUNT)) {
+		displayMode = static_cast<DisplayModes>(aScreen);
+		menuField = 0;
+	}
+}
+
+// Вправо - больше, влево - меньше, по кругу между пределами поля
+void editField(bool aUp, uint8_t aStep)
+{
+	const Menu::Screen screen = currentScreen();
+	if (menuField >= screen.fieldCount) {
+		return;
+	}
+
+	const Menu::Field field = screenField(screen, menuField);
+	const uint16_t step = static_cast<uint16_t>(field.step) * aStep;
+
+	if (screen.load) {
+		screen.load();
+	}
+	const int16_t value = Menu::get(field);
+	Menu::set(field, aUp ? Menu::stepUp(value, step, field.min, field.max) : Menu::stepDown(value, step, field.min, field.max));
+	if (screen.changed) {
+		screen.changed();
+	}
+
+	wakeTimeTasks();
+}
+
+void onEncoderRight(uint8_t aStep)
+{
+	if (modeConf) {
+		editField(true, aStep);
+	} else {
+		showScreen(currentScreen().right);
+	}
+
+	wake(Tasks::DISPLAY);
+}
+
+void onEncoderLeft(uint8_t aStep)
+{
+	if (modeConf) {
+		editField(false, aStep);
+	} else {
+		showScreen(currentScreen().left);
+	}
+
+	wake(Tasks::DISPLAY);
+}
+
+void onEncoderPress()
+{
+	// Обработчик коротких нажатий энкодера
+
+	const Menu::Screen screen = currentScreen();
+
+	if (menuField + 1 < screen.fieldCount) {
+		++menuField;
+	} else {
+		showScreen(screen.leave ? screen.leave() : screen.next);
+	}
+
+	if (errorState && !pumpLocked) {
+		errorState = false; // Сбросим флаг ошибки отсюда (временно)
+		wake(Tasks::INDICATION);
+	}
+
+	wake(Tasks::DISPLAY);
+}
+
+void onEncoderHold()
+{
+	// Обработчик длинных нажатий энкодера
+
+	if (modeConf) {
+		modeConf = false;
+		commitCurrentTime(); // Настройку могли закрыть прямо с экрана времени
+		eepromWrite();
+		showScreen(toScreen(pumpLocked ? DisplayModes::PUMP_LOCKED : DisplayModes::TIME));
+	} else {
+		modeConf = true;
+		showScreen(toScreen(DisplayModes::SET_CUR_TIME));
+	}
+
+	wakeTimeTasks();
+	wake(Tasks::DISPLAY);
+}
+// Меняет только теневое состояние, на выводы оно попадет в конце прохода цикла
+void switchPeriph(Periphs aPeriph, bool aMode)
+{
+	outputs.set(static_cast<uint8_t>(aPeriph), aMode);
+
+	if (aPeriph == Periphs::LAMP) {
+		lampState = aMode;
+	}
+}
+
+// Регистр сравнения ШИМ пишется только при смене уровня
+void setLampLevel(uint8_t aLevel)
+{
+	if (aLevel != lampLevel) {
+		lampLevel = aLevel;
+		Hal::lampPwm(LampDimmer::duty(aLevel));
+	}
+}
+
+// Запись настроек отдельной задачей: ошибка за один проход меняет счетчик и блокировку и пишет несколько
+// записей журнала, а слот настроек - до 64 байт по 3,4 мс. Все изменения прохода уйдут одной записью
+void saveSettings()
+{
+	wake(Tasks::SETTINGS);
+}
+
+// Счетчик статистики хранится в записи настроек, поэтому переживает перезагрузку и затирание журнала.
+// Копится он в ОЗУ: запись слота на каждый цикл залива - десятки записей в сутки и лишний износ EEPROM.
+// Запись уходит с ближайшим сохранением настроек, но не позже kStatisticsSavePeriod, при пропадании
+// питания теряется не больше этого времени счета
+void countStatistic(uint16_t &aCounter)
+{
+	if (aCounter < UINT16_MAX) {
+		++aCounter;
+		if (!scheduler.scheduled(static_cast<uint8_t>(Tasks::SETTINGS))) {
+			wake(Tasks::SETTINGS, kStatisticsSavePeriod);
+		}
+	}
+}
+
+// Конец залива: в журнал, и если камера заполнялась, цикл засчитывается
+void finishFlood()
+{
+	logEvent(LogEvents::PUMP_OFF, floodTrips);
+	if (floodTrips) {
+		countStatistic(statistics.successed);
+	}
+}
+
+// Насос выключается и не включится до сброса с экрана, блокировка переживает перезагрузку.
+// Лампа, индикация, экран и журнал продолжают работать
+void lockPump()
+{
+	Hal::floatCutoff(false);
+	switchPeriph(Periphs::PUMP, false);
+	switchPeriph(Periphs::BLUELED, false);
+	if (pumpState) {
+		finishFlood();
+	}
+	pumpState = false;
+	swingState = false;
+	pumpCheckNeeded = false;
+
+	if (!pumpLocked) {
+		pumpLocked = true;
+		logEvent(LogEvents::PUMP_LOCKED);
+		saveSettings();
+	}
+
+	// Настройку и несбрасываемую ошибку поплавка не перебиваем, экран покажется после них
+	if (!modeConf && displayMode != DisplayModes::ERROR_NOFLOATLEV) {
+		showScreen(toScreen(DisplayModes::PUMP_LOCKED));
+		wake(Tasks::DISPLAY);
+	}
+}
+
+// Нажатие на экране блокировки. Ошибку снимет onEncoderPress(), насос вернется к текущей фазе
+uint8_t unlockPump()
+{
+	pumpLocked = false;
+	logEvent(LogEvents::PUMP_UNLOCKED);
+	eepromWrite();
+	wake(Tasks::PUMP);
+	return toScreen(DisplayModes::TIME);
+}
+
+void handleError(ErrorTypes aType)
+{
+	uint32_t currentUnixTime{timeService.unixTime()};
+
+	logEvent(LogEvents::ERROR, static_cast<uint8_t>(aType));
+	errorState = true; // Поставим флаг ошибки
+	wake(Tasks::INDICATION);
+	nextErrorCleanTime = currentUnixTime + (60 * kErrorCleanPeriod);
+	lastErrorTime = currentUnixTime;
+
+	switch (aType) {
+		case ErrorTypes::CRITICAL: // Камера не заполнилась за отведенное время, возможен потоп. Только в режиме NORMAL
+			countStatistic(statistics.errors);
+			lockPump();
+			break;
+		case ErrorTypes::ERROR: // Ошибка, требующая сброса
+			countStatistic(statistics.errors); // Инкремент счетчика ошибок
+			break;
+		case ErrorTypes::WARNING: // Предупреждение
+			break;
+	}
+}
+
+// Секунда, в которой наступит срок aDeadline (сроки насоса сравниваются строго: now > deadline)
+uint32_t pumpDueTime(uint32_t aDeadline, uint32_t aCurrentUnixTime)
+{
+	return static_cast<int32_t>(aDeadline + 1 - aCurrentUnixTime) > 0 ? aDeadline + 1 : aCurrentUnixTime + 1;
+}
+
+void pumpTask()
+{
+	if (pumpLocked) {
+		switchPeriph(Periphs::PUMP, false); // Задачу разбудит снятие блокировки
+		return;
+	}
+
+	uint32_t currentUnixTime{timeService.unixTime()};                  // Добавляется для правильного подсчета интервалов работы насоса
+	// Фаза считается от эпохи, пропущенные из-за перезагрузки или перевода часов переключения не повторяются
+	const PumpPhase::Phase phase = pumpPhase(currentUnixTime);
+
+	switch (hydroType) {
+		case HydroTypes::NORMAL :{
+			// Нормальный режим - просто переключаем насос по интервалам
+			// Проверим тайминги для насоса
+			if (phase.flood != pumpState) {
+			// Если пришло время переключения - переключаем
+
+				if (!pumpState) {
+					switchPeriph(Periphs::PUMP, true);
+					switchPeriph(Periphs::BLUELED, true);
+					logEvent(LogEvents::PUMP_ON, static_cast<uint8_t>(hydroType));
+					floodTrips = 0;
+					pumpState = true;
+
+					// Включаем таймер для проверки статуса поплавкого уровня внутри камеры
+					pumpNextCheckTime = currentUnixTime + maxTimeForFullFlood; 
+					pumpCheckNeeded = true;
+				} else {
+					switchPeriph(Periphs::PUMP, false);
+					switchPeriph(Periphs::BLUELED, false);
+					finishFlood();
+					pumpState = false;
+				}
+			}
+
+			if ((currentUnixTime > pumpNextCheckTime) && pumpCheckNeeded) {
+				if (Hal::floatLevel()) {
+					pumpCheckNeeded = false; // Основная камера затоплена за требуемое время, все в порядке
+					floodTrips = 1;
+				} else {
+					logEvent(LogEvents::FLOAT_TIMEOUT, static_cast<uint8_t>(hydroType));
+					handleError(ErrorTypes::CRITICAL); // Что-то пошло не так
+				}
+			}
+			break;
+		} // HydroTypes::Normal
+		case HydroTypes::SWING :{
+			// Видоизмененный нормальный режим. В период затопления насос активен не все время,
+			// он выключается по срабатыванию поплавкового уровня в камере и включается по таймауту
+			if (phase.flood != pumpState) {
+				// Переключаем режимы так же как в нормальном но не трогаем сам насос
+				if (!pumpState) {
+					logEvent(LogEvents::PUMP_ON, static_cast<uint8_t>(hydroType));
+					floodTrips = 0;
+					pumpState = true;
+					swingState = false;  //Начинаем с положения вкл
+					switchPeriph(Periphs::BLUELED, true);
+				} else {
+					pumpState = false;
+					finishFlood();
+					switchPeriph(Periphs::BLUELED, false);
+				}
+			}
+
+			if (!pumpState) {
+				Hal::floatCutoff(false);
+				switchPeriph(Periphs::PUMP, false); // Если насос не включен - то определенно он должен быть выключен
+				pumpCheckNeeded = false; // Этот флаг может не сброситься сам после окончания цикла, сбросим вручную
+			} else {
+				// Если насос включен - начинаем "качели"
+				if (!swingState && currentUnixTime > pumpNextSwingTime && Hal::floatLevel()) {
+					// Камера еще полна с прошлого раза, ждем следующий интервал не включая насос
+					pumpNextSwingTime = currentUnixTime + swingOffPeriod;
+					sendEvent(LogEvents::SWING_SKIP);
+				} else if (!swingState && currentUnixTime > pumpNextSwingTime) { // Если доп флаг насоса выключен и время для переключения пришло
+					Hal::floatCutoff(true); // Поплавок выключит насос сам, не дожидаясь этой задачи
+					switchPeriph(Periphs::PUMP, true); // включаем насос
+					pumpNextCheckTime = currentUnixTime + maxTimeForFullFlood; // Добавляем проверку на возможность затопления
+					pumpCheckNeeded = true; //активируем проверку
+					swingState = true;
+					sendEvent(LogEvents::SWING_ON);
+				} else if (Hal::floatLevel() && swingState == true) {
+					// Если концевик сработал, насос уже выключен из прерывания
+					switchPeriph(Periphs::PUMP, false); // Выключим насос
+					pumpNextSwingTime = currentUnixTime + swingOffPeriod; // Заведем таймер на интервал ожидания
+					pumpCheckNeeded = false;
+					swingState = false;
+					floodTrips = floodTrips < UINT8_MAX ? floodTrips + 1 : floodTrips;
+					sendEvent(LogEvents::SWING_OFF, floodTrips);
+				} else if (pumpCheckNeeded && currentUnixTime > pumpNextCheckTime) {
+					// Если оно долго не сбрасывалось - значит что-то пошло не так, например застрял поплавковый уровень
+					Hal::floatCutoff(false);
+					switchPeriph(Periphs::PUMP, false); // Выключим насос
+					pumpNextSwingTime = currentUnixTime + swingOffPeriod; // Заведем таймер на интервал ожидания
+					swingState = false;
+					pumpCheckNeeded = false;
+					logEvent(LogEvents::FLOAT_TIMEOUT, static_cast<uint8_t>(hydroType));
+					handleError(ErrorTypes::ERROR); // Поставим ошибку
+				} 
+			}
+			break;
+		} // HydroTypes::Swing
+	}
+
+	// Следующий запуск по ближайшему из сроков насоса
+	uint32_t next = phase.next;
+
+	if (pumpCheckNeeded) {
+		const uint32_t check = pumpDueTime(pumpNextCheckTime, currentUnixTime);
+		next = static_cast<int32_t>(check - next) < 0 ? check : next;
+	}
+
+	// Срабатывание поплавка будит задачу из coreLoop()
+	if (hydroType == HydroTypes::SWING && pumpState && !swingState) {
+		const uint32_t swing = pumpDueTime(pumpNextSwingTime, currentUnixTime);
+		next = static_cast<int32_t>(swing - next) < 0 ? swing : next;
+	}
+
+	wakeAt(Tasks::PUMP, next);
+}
+
+void lampTask()
+{
+	const uint32_t currentUnixTime{timeService.unixTime()};
+	const bool state{lightSchedule.state(currentUnixTime)};
+	LampDimmer::Step step{state ? LampDimmer::kMaxLevel : uint8_t{0}, lightSchedule.nextChange()};
+
+	if (lightSchedule.events() > 1) { // Без переключений в сутках лампа горит или не горит постоянно, рамп нет
+		step = LampDimmer::step(currentUnixTime, state, lightSchedule.lastChange(), lightSchedule.nextChange(),
+			60U * sunriseTime, 60U * sunsetTime);
+	}
+
+	switchPeriph(Periphs::LAMP, state); // Питание драйвера, яркость задает ШИМ
+	setLampLevel(step.level);
+	wakeAt(Tasks::LAMP, step.next);
+}
+
+void indicationTask()
+{
+	// Сбросим ошибку если пришло время ее сбросить
+	if (errorState && !pumpLocked && (timeService.unixTime() > nextErrorCleanTime)) {
+		errorState = false;
+	}
+
+	if (errorState) {
+		switchPeriph(Periphs::GREENLED, false); // Снимем зеленый светодиод, у нас ошибка
+
+		if (errorStatePos) {
+			switchPeriph(Periphs::REDLED, true);
+			switchPeriph(Periphs::ZUMMER, true);
+		} else {
+			switchPeriph(Periphs::REDLED, false);
+			switchPeriph(Periphs::ZUMMER, false);
+		}
+
+		errorStatePos = !errorStatePos;
+		wake(Tasks::INDICATION, kErrorBlinkingPeriod);
+	} else {
+		// Без ошибки индикация статична, задачу разбудит handleError()
+		switchPeriph(Periphs::REDLED, false);
+		switchPeriph(Periphs::ZUMMER, false);
+		switchPeriph(Periphs::GREENLED, true);
+	}
+}
+
+#ifdef PROFILER
+// Четная строка - сводка участка, нечетная - его гистограмма
+void reportProfile(uint8_t aLine, TextBuffer<64> &aText)
+{
+	const uint8_t section = aLine / 2;
+	const Profiler::Stats &stats = profiler.stats(section);
+
+	aText.appendP(PSTR("prof ")).appendP(kProfileNames[section]);
+	if (aLine % 2 == 0) {
+		aText.appendP(PSTR(": n ")).appendNumber(stats.count);
+		aText.appendP(PSTR(", us ")).appendNumber(stats.count ? Profiler::toMicros(stats.min) : 0);
+		aText.append('/').appendNumber(Profiler::toMicros(stats.count ? stats.total / stats.count : 0));
+		aText.append('/').appendNumber(Profiler::toMicros(stats.max));
+		aText.appendP(PSTR(", ovr ")).appendNumber(stats.overruns);
+	} else {
+		aText.appendP(PSTR(" hist:"));
+		for (const auto count : stats.histogram) {
+			aText.append(' ').appendNumber(count);
+		}
+	}
+}
+#endif
+
+// Опоздания задач относительно срока и профилировщик в лог, по строке за запуск
+void reportTask()
+{
+	static const char kTaskNames[][11] PROGMEM = {"display", "pump", "lamp", "indication", "report", "log",
+		"telemetry", "sensors", "memory", "settings"};
+	TextBuffer<64> line;
+
+	if (reportLine < scheduler.size()) {
+		const auto &stats = scheduler.stats(reportLine);
+
+		line.appendP(PSTR("task ")).appendP(kTaskNames[reportLine]);
+		line.appendP(PSTR(": runs ")).appendNumber(stats.runs);
+		line.appendP(PSTR(", late avg ")).appendNumber(stats.runs ? stats.lateSum / stats.runs : 0);
+		line.appendP(PSTR(" max ")).appendNumber(stats.lateMax).appendP(PSTR(" ms"));
+		Hal::log(line.c_str());
+
+		++reportLine;
+		wake(Tasks::REPORT, kReportLinePeriod);
+		return;
+	}
+
+#ifdef PROFILER
+	if (reportLine < scheduler.size() + kProfileReportLines) {
+		reportProfile(reportLine - scheduler.size(), line);
+		Hal::log(line.c_str());
+
+		++reportLine;
+		wake(Tasks::REPORT, kReportLinePeriod);
+		return;
+	}
+#endif
+
+	if (reportLine == scheduler.size() + kProfileReportLines) {
+		line.appendP(PSTR("memory: stack min ")).appendNumber(memory.stackFree);
+		line.appendP(PSTR(", free ")).appendNumber(memory.free);
+		line.appendP(PSTR(", heap top ")).appendNumber(memory.heapTop);
+		line.appendP(PSTR(", frag ")).appendNumber(memory.heapFree);
+		Hal::log(line.c_str());
+
+		++reportLine;
+		wake(Tasks::REPORT, kReportLinePeriod);
+		return;
+	}
+
+	if (reportLine == scheduler.size() + kProfileReportLines + 1) {
+		line.appendP(PSTR("rtc: read failures ")).appendNumber(timeService.readFailures());
+		line.appendP(timeService.tickAlive() ? PSTR(", sqw ok") : PSTR(", sqw lost"));
+		Hal::log(line.c_str());
+
+		++reportLine;
+		wake(Tasks::REPORT, kReportLinePeriod);
+		return;
+	}
+
+	line.appendP(PSTR("switches: pump ")).appendNumber(outputs.switches(static_cast<uint8_t>(Periphs::PUMP)));
+	line.appendP(PSTR(", lamp ")).appendNumber(outputs.switches(static_cast<uint8_t>(Periphs::LAMP)));
+	Hal::log(line.c_str());
+
+	reportLine = 0;
+	wake(Tasks::REPORT, kReportTime);
+}
+
+// Снимок состояния в телеметрию
+void telemetryTask()
+{
+	Telemetry::Snapshot snapshot;
+	snapshot.uptime = Hal::millis();
+	snapshot.unixTime = timeService.unixTime();
+	snapshot.flags = (pumpState ? Telemetry::kFlagFloodPhase : 0)
+		| (outputs.get(static_cast<uint8_t>(Periphs::PUMP)) ? Telemetry::kFlagPump : 0)
+		| (swingState ? Telemetry::kFlagSwing : 0)
+		| (lampState || lampLevel ? Telemetry::kFlagLamp : 0)
+		| (Hal::floatLevel() ? Telemetry::kFlagFloat : 0)
+		| (errorState ? Telemetry::kFlagError : 0)
+		| (modeConf ? Telemetry::kFlagSetup : 0)
+		| (pumpLocked ? Telemetry::kFlagLocked : 0);
+	snapshot.lampLevel = lampLevel;
+	snapshot.hydroType = static_cast<uint8_t>(hydroType);
+	snapshot.floodTrips = floodTrips;
+	snapshot.errors = static_cast<uint16_t>(statistics.errors);
+	snapshot.successed = static_cast<uint16_t>(statistics.successed);
+	snapshot.loops = loopCount;
+	snapshot.loopMax = loopMaxTime;
+	snapshot.dropped = Hal::telemetryDropped();
+	snapshot.ph = currentPH;
+	snapshot.ec = currentEC;
+	snapshot.temperature = currentTemperature;
+	snapshot.stackFree = memory.stackFree;
+	snapshot.heapFree = memory.heapFree;
+
+	uint8_t payload[Telemetry::kSnapshotSize];
+	Hal::telemetry(Telemetry::Type::SNAPSHOT, payload, Telemetry::pack(snapshot, payload));
+
+	loopCount = 0;
+	loopMaxTime = 0;
+	wake(Tasks::TELEMETRY, kTelemetryPeriod);
+}
+
+// Наименьший запас только уменьшается. Предупреждение - на каждом новом минимуме ниже порога,
+// так журнал получает по записи на ухудшение, а не на каждую проверку
+void memoryTask()
+{
+	const uint16_t previous = memory.stackFree;
+	Hal::memoryStatus(memory);
+
+	if (memory.stackFree < kMinStackFree && memory.stackFree < previous) {
+		logEvent(LogEvents::STACK_LOW, static_cast<uint8_t>(memory.stackFree < UINT8_MAX ? memory.stackFree : UINT8_MAX));
+		handleError(ErrorTypes::WARNING);
+	}
+
+	wake(Tasks::MEMORY, kMemoryCheckPeriod);
+}
+
+// Значения АЦП копятся в очереди из прерывания, здесь они фильтруются и пересчитываются в единицы
+void sensorTask()
+{
+	Hal::AdcSample sample;
+	while (Hal::adcSample(sample)) {
+		SensorFilter &filter = sensorFilters[static_cast<uint8_t>(sample.channel)];
+		filter.smooth.push(filter.median.push(sample.value));
+	}
+	wake(Tasks::SENSORS, kSensorPeriod);
+
+	for (const auto &filter : sensorFilters) {
+		if (!filter.smooth.primed()) {
+			return;
+		}
+	}
+
+	currentTemperature = Probe::temperature(sensorRaw(Hal::AdcChannel::TEMPERATURE));
+
+	const int32_t ph = Probe::apply(phCalibration, sensorRaw(Hal::AdcChannel::PH));
+	currentPH = static_cast<uint16_t>(ph < 0 ? 0 : (ph > kMaxPh ? kMaxPh : ph));
+
+	const int32_t ec = Probe::compensateEc(Probe::apply(ecCalibration, sensorRaw(Hal::AdcChannel::EC)),
+		currentTemperature);
+	currentEC = static_cast<uint16_t>(ec < 0 ? 0 : (ec > UINT16_MAX ? UINT16_MAX : ec));
+	currentPPM = currentEC / 2;
+}
+
+// Стертая или испорченная запись дает выключенный период
+LightPeriod lightPeriodFrom(const TimeContainerMinimal &aOn, const TimeContainerMinimal &aOff)
+{
+	if (aOn.hours > 23 || aOn.minutes > 59 || aOff.hours > 23 || aOff.minutes > 59) {
+		return LightPeriod{};
+	}
+	return LightPeriod{TimeContainer{aOn.hours, aOn.minutes}, TimeContainer{aOff.hours, aOff.minutes}};
+}
+
+TimeContainerMinimal timeMinimal(const TimeContainer &aTime)
+{
+	return TimeContainerMinimal{aTime.hour(), aTime.minute()};
+}
+
+// Прежняя прошивка писала настройки версии 1 по адресу 0 без заголовка и CRC. Такие данные
+// принимаются, только если все поля в допустимых пределах
+bool loadLegacySettings(EepromData &aData)
+{
+	memset(&aData, 0xFF, sizeof(aData));
+	Hal::eepromRead(0, &aData, kSettingsV1Size);
+
+	return aData.pumpOnPeriod >= 1 && aData.pumpOnPeriod <= kMaxPumpPeriod
+		&& aData.pumpOffPeriod >= 1 && aData.pumpOffPeriod <= kMaxPumpPeriod
+		&& aData.lampOnTime.hours <= 23 && aData.lampOnTime.minutes <= 59
+		&& aData.lampOffTime.hours <= 23 && aData.lampOffTime.minutes <= 59
+		&& aData.swingOffPeriod <= kMaxSwingPeriod
+		&& (aData.hydroType == HydroTypes::NORMAL || aData.hydroType == HydroTypes::SWING)
+		&& aData.maxTimeForFullFlood <= kMaxTimeForFlood;
+}
+
+// Счетчики по журналу: то, что можно восстановить для записи без счетчиков, в пределах глубины журнала
+Statistics logStatistics()
+{
+	Log::Cursor cursor;
+	Log::Entry entry;
+	Statistics counted{0, 0};
+
+	eventLog.rewind(cursor);
+	while (eventLog.next(cursor, entry)) {
+		if (entry.type == static_cast<uint8_t>(LogEvents::ERROR)) {
+			++counted.errors;
+		} else if (entry.type == static_cast<uint8_t>(LogEvents::PUMP_OFF) && entry.argument) {
+			++counted.successed;
+		}
+	}
+	return counted;
+}
+
+// Дописывает поля, которых не было в версии aVersion
+void migrateSettings(EepromData &aData, uint8_t aVersion)
+{
+	if (aVersion < 2) {
+		for (auto &period : aData.lampPeriods) {
+			period = LightPeriodMinimal{{0, 0}, {0, 0}};
+		}
+		aData.sunriseTime = 0;
+		aData.sunsetTime = 0;
+		aData.pumpEpoch = PumpPhase::kNoEpoch;
+	}
+	if (aVersion < 3) {
+		aData.phCalibration = Probe::kPhDefault;
+		aData.ecCalibration = Probe::kEcDefault;
+	}
+	if (aVersion < 4) {
+		aData.pumpLocked = 0;
+	}
+	if (aVersion < 5) {
+		const Statistics counted = logStatistics();
+		aData.floodCycles = counted.successed;
+		aData.errors = counted.errors;
+	}
+}
+
+void defaultSettings()
+{
+	lampPeriods[0] = LightPeriod{TimeContainer{7, 0}, TimeContainer{23, 30}};
+	for (uint8_t i = 1; i < kLightPeriods; ++i) {
+		lampPeriods[i] = LightPeriod{};
+	}
+	pumpOnPeriod = 15;
+	pumpOffPeriod = 10;
+	pumpEpoch = PumpPhase::kNoEpoch;
+	swingOffPeriod = 10;
+	sunriseTime = 0;
+	sunsetTime = 0;
+	hydroType = HydroTypes::SWING;
+	maxTimeForFullFlood = 120;
+	phCalibration = Probe::kPhDefault;
+	ecCalibration = Probe::kEcDefault;
+	pumpLocked = false;
+	statistics = logStatistics();
+}
+
+// Выгрузка журнала в порт, по записи за запуск, чтобы не забивать буфер передачи
+void logTask()
+{
+	Log::Entry entry;
+
+	if (!eventLog.next(logCursor, entry)) {
+		Hal::log("log end");
+		return;
+	}
+
+	TextBuffer<48> line;
+	line.appendP(PSTR("log "));
+	if (entry.timeKnown) {
+		line.appendNumber(entry.time);
+	} else {
+		line.append('?');
+	}
+	line.append(' ');
+	if (entry.type < static_cast<uint8_t>(LogEvents::COUNT)) {
+		line.appendP(kLogEventNames[entry.type]);
+	} else {
+		line.appendP(PSTR("type ")).appendNumber(entry.type);
+	}
+	line.append(' ').appendNumber(entry.argument);
+	Hal::log(line.c_str());
+
+	wake(Tasks::LOG, kLogDumpPeriod);
+}
+
+void eepromRead()
+{
+	EepromData data;
+	uint8_t version{1};
+
+	if (!settingsStore.load(data, version) && !loadLegacySettings(data)) {
+		// Пустая или испорченная EEPROM: работаем на настройках по умолчанию, они сохранятся при первой записи
+		Hal::log("settings: defaults");
+		defaultSettings();
+		return;
+	}
+
+	migrateSettings(data, version);
+	pumpOnPeriod = data.pumpOnPeriod;
+	pumpOffPeriod = data.pumpOffPeriod;
+	lampPeriods[0] = lightPeriodFrom(data.lampOnTime, data.lampOffTime);
+	for (uint8_t i = 1; i < kLightPeriods; ++i) {
+		lampPeriods[i] = lightPeriodFrom(data.lampPeriods[i - 1].on, data.lampPeriods[i - 1].off);
+	}
+	swingOffPeriod = data.swingOffPeriod;
+	hydroType = data.hydroType;
+	maxTimeForFullFlood = data.maxTimeForFullFlood;
+	sunriseTime = data.sunriseTime <= kMaxRampTime ? data.sunriseTime : 0; // Стертая EEPROM - без рамп
+	sunsetTime = data.sunsetTime <= kMaxRampTime ? data.sunsetTime : 0;
+	pumpEpoch = data.pumpEpoch;
+	phCalibration = Probe::valid(data.phCalibration) ? data.phCalibration : Probe::kPhDefault;
+	ecCalibration = Probe::valid(data.ecCalibration) ? data.ecCalibration : Probe::kEcDefault;
+	pumpLocked = data.pumpLocked == 1;
+	statistics = Statistics{data.floodCycles, data.errors};
+}
+
+void eepromWrite()
+{
+	EepromData data{pumpOnPeriod, pumpOffPeriod, timeMinimal(lampPeriods[0].on), timeMinimal(lampPeriods[0].off),
+		swingOffPeriod, hydroType, maxTimeForFullFlood, {}, sunriseTime, sunsetTime, pumpEpoch, phCalibration,
+		ecCalibration, static_cast<uint8_t>(pumpLocked), statistics.successed, statistics.errors};
+	for (uint8_t i = 1; i < kLightPeriods; ++i) {
+		data.lampPeriods[i - 1] = LightPeriodMinimal{timeMinimal(lampPeriods[i].on), timeMinimal(lampPeriods[i].off)};
+	}
+	Hal::watchdogReset(); // Запись слота занимает почти половину периода сторожа, начинаем ее с полным запасом
+	settingsStore.save(data, kSettingsVersion);
+}
+
+void displayProcedure()
+{
+	const Menu::Screen screen = currentScreen();
+	Menu::Line str1;
+	Menu::Line str2;
+	const uint8_t line2X{screen.x};
+
+	if (screen.load) {
+		screen.load();
+	}
+	if (screen.title) {
+		str1.appendP(screen.title);
+	}
+	for (uint8_t i = 0; i < screen.fieldCount; ++i) {
+		Menu::render(screenField(screen, i), screen.fieldCount > 1 && i == menuField, str2);
+	}
+	if (screen.render) {
+		screen.render(str1, str2);
+	}
+
+	// Если текст не изменился, кадр не отправляем. Раз в kDisplayRedrawTime экран перерисовывается целиком,
+	// драйвер иначе пропустил бы неизменившиеся страницы, и сбившийся экран так и остался бы испорченным
+	const uint32_t key = Hash::fnv1a(str2.c_str(), Hash::fnv1a(str1.c_str(), Hash::fnv1a(&line2X, sizeof(line2X))));
+	const uint32_t currentTime = Hal::millis();
+	const bool redraw = currentTime - lastRedrawTime >= kDisplayRedrawTime;
+
+	if (key == screenKey && !redraw) {
+		return;
+	}
+
+	if (redraw) {
+		Hal::displayRefresh();
+		lastRedrawTime = currentTime;
+	}
+	screenKey = key;
+
+	Hal::displayClear();
+	Hal::displayPrint(0, 0, str1.c_str());
+	Hal::displayPrint(line2X, 18, str2.c_str());
+	Hal::displayFlush();
+}
+
+void displayTask()
+{
+	const uint8_t section = Bench::kDisplay + static_cast<uint8_t>(displayMode);
+	// Пока прошлый кадр уходит по шине, текст экрана менять нельзя, кадр пропускается
+	if (!Hal::displayBusy()) {
+		const uint32_t start = profiler.start();
+		Bench::begin(section);
+		displayProcedure();
+		Bench::end(section);
+		profile(ProfileSections::DISPLAY, start);
+	}
+
+	wake(Tasks::DISPLAY, kDisplayUpdateTime);
+}
+
+void firstInit()
+{
+	// Заберем время из системы во время компиляции
+	if (!timeService.set(Hal::buildTime())) {
+		logEvent(LogEvents::RTC_FAILED);
+	}
+	defaultSettings();
+}
+
+void coreSetup()
+{
+	// Сбросим рабочее состояние, чтобы ядро можно было перезапускать в хостовой сборке
+	pumpState = false;
+	swingState = false;
+	lampState = false;
+	modeConf = false;
+	errorState = false;
+	errorStatePos = false;
+	pumpLocked = false;
+	pumpCheckNeeded = false;
+	floodTrips = 0;
+	reportLine = 0;
+	statusPage = 0;
+	memory = Hal::MemoryStatus{UINT16_MAX, 0, 0, 0};
+	profiler = decltype(profiler){kProfileBudgets};
+	loopCount = 0;
+	loopMaxTime = 0;
+	statistics = Statistics{0, 0};
+	for (auto &filter : sensorFilters) {
+		filter = SensorFilter{};
+	}
+	currentPH = 0;
+	currentEC = 0;
+	currentPPM = 0;
+	currentTemperature = Probe::kNoTemperature;
+	pumpNextCheckTime = 0;
+	pumpNextSwingTime = 0;
+	nextErrorCleanTime = 0;
+	lastErrorTime = 0;
+	lastRedrawTime = Hal::millis();
+	screenKey = 0;
+	lampPeriod = 0;
+	menuField = 0;
+	lampLevel = 0;
+
+	outputs = decltype(outputs){};
+	settingsStore = SettingsStore{};
+	Hal::telemetryInit();
+
+	// Порядок регистрации задает номера из Tasks
+	scheduler = decltype(scheduler){};
+	scheduler.add(displayTask);
+	scheduler.add([](){
+		const uint32_t start = profiler.start();
+		Bench::begin(Bench::kPumpTask);
+		pumpTask();
+		Bench::end(Bench::kPumpTask);
+		profile(ProfileSections::PUMP, start);
+	});
+	scheduler.add([](){
+		Bench::begin(Bench::kLampTask);
+		lampTask();
+		Bench::end(Bench::kLampTask);
+	});
+	scheduler.add([](){
+		Bench::begin(Bench::kIndicationTask);
+		indicationTask();
+		Bench::end(Bench::kIndicationTask);
+	});
+	scheduler.add(reportTask);
+	scheduler.add(logTask);
+	scheduler.add(telemetryTask);
+	scheduler.add(sensorTask);
+	scheduler.add(memoryTask);
+	scheduler.add(eepromWrite);
+
+	// Сторож включается до первого обращения к шине: зависшая шина или RTC не остановят запуск навсегда.
+	// Запуск целиком дольше периода сторожа, поэтому после долгих шагов он сбрасывается
+	Hal::watchdogInit();
+	Hal::rtcInit();
+	const bool rtcSynced = timeService.begin();
+	Hal::watchdogReset();
+	eventLog = Log{};
+	eventLog.begin();
+	logEvent(LogEvents::BOOT, static_cast<uint8_t>(Hal::resetCause()));
+	if (!rtcSynced) {
+		logEvent(LogEvents::RTC_FAILED);
+	}
+	pinInit();
+	outputs.begin();
+	eepromRead(); // Сначала вспомнили из еепром
+	Hal::watchdogReset();
+
+	if (!EncKeyPin::read()) { // потом если надо залили сверху
+		firstInit();
+		Hal::watchdogReset();
+	}
+
+	lightSchedule.build(lampPeriods);
+
+	Hal::displayInit();
+	Hal::watchdogReset();
+	switchPeriph(Periphs::GREENLED, true);
+
+	if (Hal::floatLevel()) { // Проверяем на старте есть ли поплавковый уровень в системе
+		displayMode = DisplayModes::ERROR_NOFLOATLEV; // Если нет - ошибка, без него работать нельзя, ошибка несбрасываемая
+		logEvent(LogEvents::FLOAT_MISSING);
+		handleError(ErrorTypes::ERROR);
+	} else if (pumpLocked) {
+		displayMode = DisplayModes::PUMP_LOCKED; // Блокировка из EEPROM: насос стоит, тревога звучит до сброса
+		errorState = true;
+	} else {
+		displayMode = DisplayModes::TIME; // Иначе включаемся
+	}
+
+	if (pumpEpoch == PumpPhase::kNoEpoch) {
+		// Первый запуск: начинаем с положения выкл, эпоху запомним, чтобы после перезагрузки продолжить ту же фазу
+		pumpEpoch = timeService.unixTime() - 60UL * pumpOnPeriod;
+		eepromWrite();
+		Hal::watchdogReset();
+	}
+
+	wake(Tasks::DISPLAY, kDisplayUpdateTime);
+	wake(Tasks::PUMP);
+	wake(Tasks::LAMP);
+	wake(Tasks::INDICATION);
+	wake(Tasks::REPORT, kReportTime);
+	wake(Tasks::TELEMETRY);
+	wake(Tasks::SENSORS, kSensorPeriod);
+	wake(Tasks::MEMORY);
+	outputs.commit();
+}
+
+void coreLoop()
+{
+	Hal::watchdogReset();
+
+	const uint32_t loopStart = Hal::micros();
+	const uint32_t loopTicks = profiler.start();
+
+	timeService.update();
+	profile(ProfileSections::TIME, loopTicks);
+	Hal::displayService();
+
+	const uint32_t encoderTicks = profiler.start();
+	Bench::begin(Bench::kEncoderEvents);
+	EncoderEvent event;
+	while (Hal::encoderEvent(event)) {
+		switch (event.type) {
+			case EncoderEvent::Type::RIGHT:
+				onEncoderRight(encoderStep(event.interval));
+				break;
+			case EncoderEvent::Type::LEFT:
+				onEncoderLeft(encoderStep(event.interval));
+				break;
+			case EncoderEvent::Type::PRESS:
+				onEncoderPress();
+				break;
+			case EncoderEvent::Type::HOLD:
+				onEncoderHold();
+				break;
+		}
+	}
+	Bench::end(Bench::kEncoderEvents);
+	profile(ProfileSections::ENCODER, encoderTicks);
+
+	char command;
+	while (Hal::logRead(command)) {
+		if (command == kLogDumpCommand) {
+			Hal::log("log begin");
+			eventLog.rewind(logCursor);
+			wake(Tasks::LOG);
+		} else if (command == kReportCommand) {
+			reportLine = 0;
+			wake(Tasks::REPORT);
+		}
+	}
+
+	// Изменения поплавка приходят из прерывания, насос при переполнении уже выключен
+	bool floatFull;
+	while (Hal::floatEvent(floatFull)) {
+		wake(Tasks::PUMP);
+	}
+
+	scheduler.run(Hal::millis());
+	outputs.commit();
+
+	const uint32_t loopTime = Hal::micros() - loopStart;
+	loopMaxTime = loopTime < loopMaxTime ? loopMaxTime : (loopTime < UINT16_MAX ? loopTime : UINT16_MAX);
+	++loopCount;
+	profile(ProfileSections::LOOP, loopTicks);
+}
+
+uint32_t coreNextDeadline()
+{
+	static constexpr Tasks kOutputTasks[]{Tasks::PUMP, Tasks::LAMP, Tasks::INDICATION};
+	uint32_t next = Hal::millis() + kMaxIdleTime;
+
+	for (const Tasks task : kOutputTasks) {
+		const uint8_t id = static_cast<uint8_t>(task);
+		if (scheduler.scheduled(id) && static_cast<int32_t>(scheduler.deadline(id) - next) < 0) {
+			next = scheduler.deadline(id);
+		}
+	}
+	return next;
+}
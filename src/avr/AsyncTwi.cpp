@@ -0,0 +1,270 @@
+//
+// AsyncTwi.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+#include "AsyncTwi.hpp"
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+#include <util/twi.h>
+
+namespace {
+
+static_assert((AsyncTwi::kQueueSize & (AsyncTwi::kQueueSize - 1)) == 0, "Queue size must be a power of two");
+
+static constexpr uint8_t kMask{AsyncTwi::kQueueSize - 1};
+static constexpr uint8_t kControl{_BV(TWEN) | _BV(TWIE) | _BV(TWINT)};
+static constexpr uint8_t kSda{_BV(PORTC4)};
+static constexpr uint8_t kScl{_BV(PORTC5)};
+static constexpr uint8_t kRecoveryClocks{9}; // Ведомый, застрявший посреди байта, досылает его и отпускает SDA
+static constexpr uint8_t kRecoveryHalfPeriod{5}; // Микросекунды, около 100 кГц
+
+struct Job {
+	uint8_t address;
+	bool read;
+	uint8_t count;
+	uint8_t *rx;
+	AsyncTwi::Callback done;
+	uint8_t data[AsyncTwi::kMaxWrite];
+};
+
+Job jobs[AsyncTwi::kQueueSize];
+volatile uint8_t head{0}; // Меняет только постановка заданий из главного цикла
+volatile uint8_t tail{0}; // Меняет прерывание или снятие по сроку, задание на tail выполняется
+volatile bool busy{false};
+volatile uint32_t jobStart{0}; // millis() начала текущего задания
+uint8_t position{0};
+
+// START очередного задания. Предыдущий STOP формируется несколько микросекунд, ожидание ограничено:
+// если шина зависла, задание снимется по сроку. Вызывается при разрешенных прерываниях, когда
+// прерывание TWI не может прийти: шина свободна или TWI выключен на время восстановления
+void start()
+{
+	for (uint16_t spin = UINT16_MAX; (TWCR & _BV(TWSTO)) && spin; --spin) {}
+	jobStart = millis();
+	TWCR = kControl | _BV(TWSTA);
+}
+
+Job *reserve(uint8_t aAddress)
+{
+	if (!AsyncTwi::ready()) {
+		return nullptr;
+	}
+
+	Job *job = &jobs[head & kMask];
+	job->address = aAddress;
+	return job;
+}
+
+void commit()
+{
+	bool wasBusy;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		head = head + 1;
+		wasBusy = busy;
+		busy = true;
+	}
+
+	// Шина стояла, прерывание TWI придет только после START
+	if (!wasBusy) {
+		start();
+	}
+}
+
+void finish(bool aSuccess)
+{
+	const AsyncTwi::Callback done = jobs[tail & kMask].done;
+	tail = tail + 1;
+
+	if (done) {
+		done(aSuccess);
+	}
+
+	if (tail != head) {
+		jobStart = millis();
+		TWCR = kControl | _BV(TWSTO) | _BV(TWSTA); // STOP и сразу START следующего задания
+	} else {
+		TWCR = kControl | _BV(TWSTO);
+		busy = false;
+	}
+}
+
+// Линии шины как открытый сток: ноль - вывод на выход с низким уровнем, единица - вход с подтяжкой
+void release(uint8_t aLine)
+{
+	DDRC &= ~aLine;
+	PORTC |= aLine;
+}
+
+void pull(uint8_t aLine)
+{
+	PORTC &= ~aLine;
+	DDRC |= aLine;
+}
+
+// Освобождение шины после зависшего задания: TWI отключается, SCL тактуется вручную, пока ведомый
+// не отпустит SDA, затем формируется STOP и TWI включается заново
+void recover()
+{
+	TWCR = 0;
+	release(kSda);
+
+	for (uint8_t i = 0; i < kRecoveryClocks && !(PINC & kSda); ++i) {
+		pull(kScl);
+		_delay_us(kRecoveryHalfPeriod);
+		release(kScl);
+		_delay_us(kRecoveryHalfPeriod);
+	}
+
+	pull(kSda);
+	_delay_us(kRecoveryHalfPeriod);
+	release(kScl);
+	_delay_us(kRecoveryHalfPeriod);
+	release(kSda);
+	_delay_us(kRecoveryHalfPeriod);
+
+	TWCR = _BV(TWEN) | _BV(TWIE);
+}
+
+} // namespace
+
+ISR(TWI_vect)
+{
+	Job &job = jobs[tail & kMask];
+
+	switch (TW_STATUS) {
+		case TW_START:
+		case TW_REP_START:
+			position = 0;
+			TWDR = (job.address << 1) | (job.read ? TW_READ : TW_WRITE);
+			TWCR = kControl;
+			break;
+		case TW_MT_SLA_ACK:
+		case TW_MT_DATA_ACK:
+			if (position < job.count) {
+				TWDR = job.data[position++];
+				TWCR = kControl;
+			} else {
+				finish(true);
+			}
+			break;
+		case TW_MR_SLA_ACK:
+			TWCR = job.count > 1 ? kControl | _BV(TWEA) : kControl;
+			break;
+		case TW_MR_DATA_ACK:
+			job.rx[position++] = TWDR;
+			TWCR = position + 1 < job.count ? kControl | _BV(TWEA) : kControl; // Последний байт без ACK
+			break;
+		case TW_MR_DATA_NACK:
+			job.rx[position++] = TWDR;
+			finish(true);
+			break;
+		default:
+			// NACK адреса или данных, потеря арбитража, ошибка шины: задание снимается
+			finish(false);
+			break;
+	}
+}
+
+namespace AsyncTwi {
+
+void init(uint32_t aFrequency)
+{
+	PORTC |= _BV(PORTC4) | _BV(PORTC5); // Подтяжки SDA и SCL в дополнение к внешним
+	TWSR = 0;
+	TWBR = ((F_CPU / aFrequency) - 16) / 2;
+	TWCR = _BV(TWEN) | _BV(TWIE);
+}
+
+bool ready(uint8_t aJobs)
+{
+	poll();
+	return static_cast<uint8_t>(head - tail) + aJobs <= kQueueSize;
+}
+
+bool idle()
+{
+	poll();
+	return !busy;
+}
+
+// Зависшее задание снимается при запрещенных прерываниях только на проверку срока и выключение TWI:
+// после этого прерывание TWI не придет и очередь принадлежит главному циклу, так что освобождение
+// шины и START следующего задания идут при разрешенных прерываниях. Обработчик получает ошибку
+// так же, как из прерывания, при запрещенных прерываниях
+void poll()
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (!busy || millis() - jobStart < kJobTimeout) {
+			return;
+		}
+
+		TWCR = 0;
+	}
+
+	recover();
+
+	// Обработчики написаны для прерывания и читают многобайтные счетчики других прерываний
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		const Callback done = jobs[tail & kMask].done;
+		tail = tail + 1;
+		if (done) {
+			done(false);
+		}
+	}
+
+	if (tail != head) {
+		start();
+	} else {
+		busy = false;
+	}
+}
+
+bool write(uint8_t aAddress, uint8_t aFirst, const uint8_t *aData, uint8_t aCount, Callback aDone)
+{
+	Job *job = reserve(aAddress);
+	if (!job || aCount >= kMaxWrite) {
+		return false;
+	}
+
+	job->read = false;
+	job->count = aCount + 1;
+	job->rx = nullptr;
+	job->done = aDone;
+	job->data[0] = aFirst;
+	for (uint8_t i = 0; i < aCount; ++i) {
+		job->data[i + 1] = aData[i];
+	}
+
+	commit();
+	return true;
+}
+
+bool read(uint8_t aAddress, uint8_t *aData, uint8_t aCount, Callback aDone)
+{
+	Job *job = reserve(aAddress);
+	if (!job || !aCount) {
+		return false;
+	}
+
+	job->read = true;
+	job->count = aCount;
+	job->rx = aData;
+	job->done = aDone;
+
+	commit();
+	return true;
+}
+
+void wait()
+{
+	while (!idle()) {}
+}
+
+} // namespace AsyncTwi
@@ -0,0 +1,49 @@
+//
+// AsyncTwi.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Неблокирующий мастер I2C на аппаратном TWI. Транзакции ставятся в очередь и выполняются
+// по прерыванию TWI одна за другой, главный цикл только кладет задания и забирает результаты.
+// Данные записи копируются в задание, буфер чтения должен жить до завершения.
+// Обработчик завершения вызывается из прерывания и не должен ставить задания: очередь пополняет
+// только главный цикл. Задание, не завершившееся за kJobTimeout (ведомый держит SDA или SCL),
+// снимается с ошибкой при следующей постановке или опросе, шина при этом освобождается
+
+#pragma once
+
+#include <stdint.h>
+
+namespace AsyncTwi {
+
+static constexpr uint8_t kQueueSize{4};
+static constexpr uint8_t kMaxWrite{32}; // Вместе с первым байтом (регистр или управляющий байт)
+static constexpr uint8_t kJobTimeout{10}; // Миллисекунды, самое длинное задание на 100 кГц идет около 3 мс
+
+using Callback = void (*)(bool aSuccess);
+
+void init(uint32_t aFrequency);
+
+// В очереди есть место на aJobs заданий
+bool ready(uint8_t aJobs = 1);
+
+// Все задания выполнены
+bool idle();
+
+// Проверка срока текущего задания. Вызывается из ready(), idle() и wait(), отдельно - если
+// главный цикл ждет результата, ничего не ставя в очередь
+void poll();
+
+// Запись aFirst и aCount байт из aData. false, если очередь заполнена
+bool write(uint8_t aAddress, uint8_t aFirst, const uint8_t *aData, uint8_t aCount, Callback aDone = nullptr);
+
+// Чтение aCount байт в aData. false, если очередь заполнена
+bool read(uint8_t aAddress, uint8_t *aData, uint8_t aCount, Callback aDone = nullptr);
+
+// Ожидание, пока очередь не опустеет. Только для инициализации и редких синхронных операций,
+// зависшее задание снимается по сроку, поэтому ожидание конечно
+void wait();
+
+} // namespace AsyncTwi
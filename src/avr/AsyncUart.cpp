@@ -0,0 +1,69 @@
+//
+// AsyncUart.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+#include "AsyncUart.hpp"
+#include "RingBuffer.hpp"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+namespace {
+
+RingBuffer<uint8_t, AsyncUart::kTxSize> tx;
+RingBuffer<uint8_t, AsyncUart::kRxSize> rx;
+
+} // namespace
+
+ISR(USART_UDRE_vect)
+{
+	uint8_t data;
+	if (tx.pop(data)) {
+		UDR0 = data;
+	} else {
+		UCSR0B &= ~_BV(UDRIE0); // Очередь пуста, прерывание включит следующая запись
+	}
+}
+
+ISR(USART_RX_vect)
+{
+	const uint8_t data = UDR0;
+	rx.push(data); // При переполнении байт теряется
+}
+
+namespace AsyncUart {
+
+void init(uint32_t aBaudRate)
+{
+	// Удвоенная скорость: ошибка частоты на 115200 при 16 МГц 2.1% вместо 3.5%
+	UCSR0A = _BV(U2X0);
+	UBRR0 = (F_CPU / 4 / aBaudRate - 1) / 2;
+	UCSR0C = _BV(UCSZ01) | _BV(UCSZ00); // 8N1
+	UCSR0B = _BV(TXEN0) | _BV(RXEN0) | _BV(RXCIE0);
+}
+
+bool write(const uint8_t *aData, uint8_t aCount)
+{
+	if (kTxSize - tx.size() < aCount) {
+		return false;
+	}
+
+	for (uint8_t i = 0; i < aCount; ++i) {
+		tx.push(aData[i]);
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		UCSR0B |= _BV(UDRIE0);
+	}
+	return true;
+}
+
+bool read(uint8_t &aByte)
+{
+	return rx.pop(aByte);
+}
+
+} // namespace AsyncUart
@@ -0,0 +1,29 @@
+//
+// AsyncUart.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Неблокирующий USART0. Передача идет из кольцевого буфера по прерыванию опустошения регистра
+// данных, главный цикл только кладет байты. Блок, которому не хватает места, не записывается
+// целиком, так что в линию не попадают обрывки кадров. Принятые байты копятся в своей очереди
+
+#pragma once
+
+#include <stdint.h>
+
+namespace AsyncUart {
+
+static constexpr uint8_t kTxSize{128};
+static constexpr uint8_t kRxSize{16};
+
+void init(uint32_t aBaudRate);
+
+// Кладет aCount байт в очередь передачи. false - места нет, ничего не записано
+bool write(const uint8_t *aData, uint8_t aCount);
+
+// Следующий принятый байт, false если очередь пуста
+bool read(uint8_t &aByte);
+
+} // namespace AsyncUart
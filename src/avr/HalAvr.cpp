@@ -0,0 +1,618 @@
+//
+// HalAvr.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Реализация HAL для Arduino Nano (ATmega328)
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include <string.h>
+#include <util/atomic.h>
+#include "AsyncTwi.hpp"
+#include "AsyncUart.hpp"
+#include "Board.hpp"
+#include "Ds3231.hpp"
+#include "Hal.hpp"
+#include "LampDimmer.hpp"
+#include "RingBuffer.hpp"
+#include "Ssd1306Text.hpp"
+
+static constexpr uint8_t kDisplayAddress{0x3C};
+static constexpr uint32_t kTwiFrequency{400000};
+static constexpr uint32_t kTelemetryBaudRate{115200};
+
+// Счетчик переполнений Timer0 из wiring.c ядра Arduino, на нем же работают millis() и micros()
+extern "C" volatile unsigned long timer0_overflow_count;
+
+// Символы компоновщика и malloc из avr-libc: конец статических данных, вершина ОЗУ, куча
+struct __freelist {
+	size_t sz;
+	struct __freelist *nx;
+};
+
+extern "C" {
+extern uint8_t _end;
+extern uint8_t __stack;
+extern char __heap_start;
+extern char *__brkval;
+extern struct __freelist *__flp;
+}
+
+static constexpr uint8_t kStackCanary{0xC5};
+
+// Метка на всю свободную память до конструкторов и main(). Указатель стека еще не настроен и
+// r1 не обнулен, поэтому только ассемблер без обращений к стеку
+extern "C" void paintStack() __attribute__((naked, used, section(".init1")));
+
+void paintStack()
+{
+	__asm__ __volatile__(
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n"
+		:: "M"(kStackCanary));
+}
+
+// Сторож: сначала прерывание, которое выключает насос в обход зависшего кода, через такой же период
+// сброс. Флаги сброса и метка прерывания лежат в .noinit и переживают перезапуск
+static constexpr uint16_t kWatchdogMark{0x5AFE};
+static constexpr uint8_t kWatchdogPeriod{_BV(WDP2) | _BV(WDP0)}; // 0.5 с
+static constexpr uint8_t kWatchdogTripped{0x80}; // Свободный бит MCUSR в копии: прерывание сторожа было
+static constexpr uint8_t kResetFlagsMask{_BV(PORF) | _BV(EXTRF) | _BV(BORF) | _BV(WDRF)};
+
+static uint8_t resetFlags __attribute__((section(".noinit"))); // .bss обнуляется позже .init3
+static volatile uint16_t watchdogMark __attribute__((section(".noinit")));
+
+// После сброса сторожем он остается включен с самым коротким периодом, выключить его нужно до
+// конструкторов. MCUSR очищается, иначе WDRF снова включит сторож.
+// Загрузчик nanoatmega328new - optiboot. Начиная с 6.x он передает прежний MCUSR в r2, а сам MCUSR
+// очищает только частично (8.x оставляет EXTRF), поэтому сначала смотрим MCUSR, а r2 - если тот пуст.
+// Старый optiboot 4.4 очищает MCUSR и r2 не задает, такое значение принимается, только если похоже
+// на флаги сброса. Сброс нашим сторожем виден по метке в .noinit при любом загрузчике
+extern "C" void saveResetFlags() __attribute__((naked, used, section(".init3")));
+
+void saveResetFlags()
+{
+	uint8_t flags = MCUSR;
+	if (!flags) {
+		__asm__ __volatile__("mov %0, r2" : "=r"(flags));
+		if (flags & ~kResetFlagsMask) {
+			flags = 0;
+		}
+	}
+
+	resetFlags = flags | (watchdogMark == kWatchdogMark ? kWatchdogTripped : 0);
+	MCUSR = 0;
+	watchdogMark = 0;
+	wdt_disable();
+}
+
+// Передача в SSD1306 заданиями асинхронного TWI, один байт задания уходит на управляющий байт
+struct TwiBus {
+	static constexpr uint8_t kChunk{AsyncTwi::kMaxWrite - 1};
+
+	static bool ready()
+	{
+		return AsyncTwi::ready();
+	}
+
+	static bool write(uint8_t aControl, const uint8_t *aData, uint8_t aCount)
+	{
+		return AsyncTwi::write(kDisplayAddress, aControl, aData, aCount);
+	}
+};
+
+static Ssd1306Text<TwiBus> display;
+
+enum class RtcRead : uint8_t {
+	IDLE,
+	BUSY,
+	DONE,
+	FAILED
+};
+
+static uint8_t rtcRegisters[Ds3231::kTimeSize];
+static volatile RtcRead rtcReadState{RtcRead::IDLE};
+static volatile uint32_t rtcReadTicks{0};
+
+static volatile uint32_t rtcTickCount{0};
+static volatile bool rtcSqwLevel{true};
+
+// Вектор прерывания выбирается по порту, поэтому порт вывода проверяется при сборке
+static_assert(RtcSqwPin::kPort == Port::C, "SQW must be on PORTC (PCINT1)");
+static_assert(FloatLevelPin::kPort == Port::B, "Float must be on PORTB (PCINT0)");
+static_assert(EncS1Pin::kPort == Port::D && EncS2Pin::kPort == Port::D && EncKeyPin::kPort == Port::D,
+	"Encoder must be on PORTD (PCINT2)");
+static_assert(LampDimPin::kPort == Port::B && LampDimPin::kMask == _BV(PB2), "Lamp PWM must be on OC1B (PB2)");
+
+// SQW на A3 (PC3). Секунды в DS3231 меняются по спаду меандра 1 Гц
+ISR(PCINT1_vect)
+{
+	const bool level = RtcSqwPin::read();
+	if (!level && rtcSqwLevel) {
+		++rtcTickCount;
+	}
+	rtcSqwLevel = level;
+}
+
+static volatile uint8_t floatDebounceLeft{0};
+static uint8_t floatDebounceTime{0};
+static volatile bool floatStable{false};
+static volatile bool floatCutoffArmed{false};
+static RingBuffer<bool, 4> floatEvents;
+
+// Поплавок на D8 (PB0). Любой фронт перезапускает выдержку на Timer2
+ISR(PCINT0_vect)
+{
+	floatDebounceLeft = floatDebounceTime;
+	TCNT2 = 0;
+	TIFR2 = _BV(OCF2A);
+	TCCR2B = _BV(CS22); // clk/64, сравнение раз в 1 мс
+}
+
+ISR(TIMER2_COMPA_vect)
+{
+	if (--floatDebounceLeft) {
+		return;
+	}
+
+	TCCR2B = 0; // Выдержка закончилась, таймер стоит до следующего фронта
+
+	const bool level = FloatLevelPin::read();
+	if (level == floatStable) {
+		return; // Дребезг, уровень вернулся
+	}
+
+	floatStable = level;
+	if (level && floatCutoffArmed) {
+		PumpPin::low();
+		floatCutoffArmed = false;
+	}
+	floatEvents.push(level);
+}
+
+// Главный цикл не сбросил сторож за период. Насос выключается здесь же, отсечка снимается, чтобы
+// ничего его не включило, сброс наступит через период, если цикл не успеет
+ISR(WDT_vect)
+{
+	PumpPin::low();
+	floatCutoffArmed = false;
+	watchdogMark = kWatchdogMark;
+}
+
+static constexpr uint8_t kAdcChannels{static_cast<uint8_t>(Hal::AdcChannel::COUNT)};
+static constexpr uint8_t kAdcShift{Hal::kAdcBits - 10}; // Сумма 4^n отсчетов делится на 2^n
+static_assert(Hal::kAdcOversampling == 1U << (2 * kAdcShift), "Oversampling must be 4^(kAdcBits - 10)");
+static_assert(kPhProbePin == 14 && kEcProbePin == 15 && kTemperatureProbePin == 16,
+	"Probe pins must match ADC channels A0..A2");
+
+static uint8_t adcChannel{0};
+static uint16_t adcCount{0};
+static uint32_t adcSum{0};
+static bool adcSkip{false};
+static RingBuffer<Hal::AdcSample, 16> adcSamples;
+
+// Непрерывные преобразования: когда приходит результат, следующее уже идет, поэтому смена канала
+// действует через одно преобразование, и отсчет сразу после переключения выбрасывается.
+// Заодно у входа с высоким сопротивлением (pH) есть время зарядить конденсатор выборки
+ISR(ADC_vect)
+{
+	const uint16_t value = ADC;
+	if (adcSkip) {
+		adcSkip = false;
+		return;
+	}
+
+	adcSum += value;
+	if (++adcCount < Hal::kAdcOversampling) {
+		return;
+	}
+
+	adcSamples.push(Hal::AdcSample{static_cast<Hal::AdcChannel>(adcChannel), static_cast<uint16_t>(adcSum >> kAdcShift)});
+	adcSum = 0;
+	adcCount = 0;
+	adcChannel = adcChannel + 1 < kAdcChannels ? adcChannel + 1 : 0;
+	ADMUX = _BV(REFS0) | adcChannel;
+	adcSkip = true;
+}
+
+static RotaryEncoder encoder;
+
+// Энкодер на D2, D3 и D4 (PD2..PD4)
+ISR(PCINT2_vect)
+{
+	encoder.onChange(EncS1Pin::read(), EncS2Pin::read(), EncKeyPin::read(), ::millis());
+}
+
+// Чтение времени - два задания: установка указателя регистров и само чтение. Метка, пришедшая
+// между ними, означает, что неизвестно, к какой секунде относятся регистры
+static void onRtcPointer(bool aSuccess)
+{
+	rtcReadTicks = rtcTickCount;
+	if (!aSuccess) {
+		rtcReadState = RtcRead::FAILED;
+	}
+}
+
+static void onRtcTime(bool aSuccess)
+{
+	if (!aSuccess || rtcReadState == RtcRead::FAILED || rtcTickCount != rtcReadTicks) {
+		rtcReadState = RtcRead::FAILED;
+	} else {
+		rtcReadState = RtcRead::DONE;
+	}
+}
+
+// Блокирующая запись для редких операций: настройка и установка времени
+static void twiWrite(uint8_t aAddress, uint8_t aRegister, const uint8_t *aData, uint8_t aCount)
+{
+	while (!AsyncTwi::write(aAddress, aRegister, aData, aCount)) {}
+}
+
+static void twiBegin()
+{
+	static bool started{false};
+	if (!started) {
+		AsyncTwi::init(kTwiFrequency);
+		started = true;
+	}
+}
+
+static uint8_t telemetrySequence{0};
+static uint16_t telemetryDropCount{0};
+
+namespace Hal {
+
+uint32_t millis()
+{
+	return ::millis();
+}
+
+uint32_t micros()
+{
+	return ::micros();
+}
+
+uint32_t ticks()
+{
+	uint32_t overflows;
+	uint8_t count;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		overflows = timer0_overflow_count;
+		count = TCNT0;
+		// Переполнение уже случилось, но прерывание еще не успело его сосчитать
+		if ((TIFR0 & _BV(TOV0)) && count < UINT8_MAX) {
+			++overflows;
+		}
+	}
+	return overflows << 8 | count;
+}
+
+void rtcInit()
+{
+	twiBegin();
+}
+
+bool rtcRequest()
+{
+	if (rtcReadState == RtcRead::BUSY || !AsyncTwi::ready(2)) {
+		return false;
+	}
+
+	rtcReadState = RtcRead::BUSY;
+	AsyncTwi::write(Ds3231::kAddress, Ds3231::kTimeRegister, nullptr, 0, onRtcPointer);
+	AsyncTwi::read(Ds3231::kAddress, rtcRegisters, sizeof(rtcRegisters), onRtcTime);
+	return true;
+}
+
+RtcStatus rtcResult(uint32_t &aUnixTime, uint32_t &aTicks)
+{
+	AsyncTwi::poll(); // Зависшее чтение снимется по сроку и придет сюда как FAILED
+	switch (rtcReadState) {
+		case RtcRead::BUSY:
+			return RtcStatus::BUSY;
+		case RtcRead::DONE: {
+			// Под запретом прерываний только копия, разбор BCD идет с разрешенными прерываниями
+			uint8_t registers[Ds3231::kTimeSize];
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				memcpy(registers, rtcRegisters, sizeof(registers));
+				aTicks = rtcReadTicks;
+			}
+			aUnixTime = Ds3231::decode(registers);
+			rtcReadState = RtcRead::IDLE;
+			return RtcStatus::DONE;
+		}
+		default:
+			rtcReadState = RtcRead::IDLE;
+			return RtcStatus::FAILED;
+	}
+}
+
+void rtcWrite(uint32_t aUnixTime)
+{
+	uint8_t registers[Ds3231::kTimeSize];
+	Ds3231::encode(aUnixTime, registers);
+	twiWrite(Ds3231::kAddress, Ds3231::kTimeRegister, registers, sizeof(registers));
+}
+
+void rtcTickInit()
+{
+	const uint8_t control{Ds3231::kControlSquareWave1Hz};
+	twiWrite(Ds3231::kAddress, Ds3231::kControlRegister, &control, 1);
+	RtcSqwPin::init();
+	rtcSqwLevel = RtcSqwPin::read();
+
+	PCMSK1 |= RtcSqwPin::kMask;
+	PCIFR = _BV(PCIF1);
+	PCICR |= _BV(PCIE1);
+}
+
+uint32_t rtcTicks()
+{
+	uint32_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks = rtcTickCount;
+	}
+	return ticks;
+}
+
+uint32_t buildTime()
+{
+	return Ds3231::parseBuildTime(__DATE__, __TIME__);
+}
+
+void floatInit(uint8_t aDebounceTime)
+{
+	floatDebounceTime = aDebounceTime ? aDebounceTime : 1;
+	floatCutoffArmed = false;
+
+	// Timer2 в режиме CTC с периодом 1 мс, запускается только на время выдержки
+	TCCR2B = 0;
+	TCCR2A = _BV(WGM21);
+	OCR2A = 249;
+	TIMSK2 = _BV(OCIE2A);
+
+	FloatLevelPin::init();
+	floatStable = FloatLevelPin::read();
+
+	PCMSK0 |= FloatLevelPin::kMask;
+	PCIFR = _BV(PCIF0);
+	PCICR |= _BV(PCIE0);
+}
+
+bool floatLevel()
+{
+	return floatStable;
+}
+
+bool floatEvent(bool &aLevel)
+{
+	return floatEvents.pop(aLevel);
+}
+
+void floatCutoff(bool aArmed)
+{
+	floatCutoffArmed = aArmed;
+}
+
+void encoderInit()
+{
+	EncS1Pin::init();
+	EncS2Pin::init();
+	EncKeyPin::init();
+	encoder.begin(EncS1Pin::read(), EncS2Pin::read(), EncKeyPin::read());
+
+	PCMSK2 |= EncS1Pin::kMask | EncS2Pin::kMask | EncKeyPin::kMask;
+	PCIFR = _BV(PCIF2);
+	PCICR |= _BV(PCIE2);
+}
+
+bool encoderEvent(EncoderEvent &aEvent)
+{
+	bool result;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		result = encoder.pop(aEvent, EncKeyPin::read(), ::millis());
+	}
+	return result;
+}
+
+void lampPwmInit()
+{
+	LampDimPin::init();
+
+	// Timer1 в режиме fast PWM с TOP в ICR1, без делителя: 16 МГц / 1024 = 15.6 кГц, выше слышимого
+	TCCR1A = _BV(WGM11);
+	TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS10);
+	ICR1 = LampDimmer::kPwmTop;
+	OCR1B = 0;
+}
+
+void lampPwm(uint16_t aDuty)
+{
+	if (aDuty) {
+		OCR1B = aDuty;
+		TCCR1A |= _BV(COM1B1);
+	} else {
+		// Нулевое сравнение в fast PWM дает короткий импульс каждый период, вывод отключается от таймера
+		TCCR1A &= ~_BV(COM1B1);
+		LampDimPin::low();
+	}
+}
+
+// Опора AVcc, делитель 128: 125 кГц, около 9600 преобразований в секунду на все каналы,
+// по 12 готовых значений в секунду на канал
+void adcInit()
+{
+	adcChannel = 0;
+	adcCount = 0;
+	adcSum = 0;
+	adcSkip = false;
+	adcSamples.clear();
+
+	DIDR0 = _BV(ADC0D) | _BV(ADC1D) | _BV(ADC2D); // Цифровые входы на аналоговых выводах не нужны
+	ADMUX = _BV(REFS0);
+	ADCSRB = 0; // Непрерывный режим
+	ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+}
+
+bool adcSample(AdcSample &aSample)
+{
+	return adcSamples.pop(aSample);
+}
+
+void eepromRead(uint16_t aAddress, void *aData, size_t aSize)
+{
+	eeprom_read_block(aData, reinterpret_cast<const void *>(aAddress), aSize);
+}
+
+void eepromUpdate(uint16_t aAddress, const void *aData, size_t aSize)
+{
+	eeprom_update_block(aData, reinterpret_cast<void *>(aAddress), aSize);
+}
+
+void displayInit()
+{
+	twiBegin();
+	display.init(true); // Экран стоит вверх ногами
+}
+
+void displayClear()
+{
+	display.clear();
+}
+
+void displayPrint(uint8_t aX, uint8_t aY, const char *aText)
+{
+	display.print(aX, aY, aText);
+}
+
+void displayFlush()
+{
+	display.flush();
+}
+
+void displayRefresh()
+{
+	display.refresh();
+}
+
+void displayService()
+{
+	display.service();
+}
+
+bool displayBusy()
+{
+	return display.busy();
+}
+
+// Свой драйвер USART вместо Serial: HardwareSerial ждет места в буфере и рвет строки посередине
+void telemetryInit()
+{
+	AsyncUart::init(kTelemetryBaudRate);
+}
+
+bool telemetry(Telemetry::Type aType, const void *aPayload, uint8_t aSize)
+{
+	uint8_t frame[Telemetry::kMaxFrameSize];
+	const uint8_t size = Telemetry::frame(aType, telemetrySequence, aPayload, aSize, frame);
+
+	++telemetrySequence; // Номер расходуется и на отброшенный кадр, приемник увидит пропуск
+	if (!AsyncUart::write(frame, size)) {
+		if (telemetryDropCount < UINT16_MAX) {
+			++telemetryDropCount;
+		}
+		return false;
+	}
+	return true;
+}
+
+uint16_t telemetryDropped()
+{
+	return telemetryDropCount;
+}
+
+void log(const char *aText)
+{
+	telemetry(Telemetry::Type::TEXT, aText, static_cast<uint8_t>(strnlen(aText, Telemetry::kMaxPayload)));
+}
+
+bool logRead(char &aChar)
+{
+	uint8_t data;
+	if (!AsyncUart::read(data)) {
+		return false;
+	}
+	aChar = static_cast<char>(data);
+	return true;
+}
+
+void memoryStatus(MemoryStatus &aStatus)
+{
+	uint8_t stackMarker; // Адрес локальной переменной - почти вершина стека
+	const uint8_t *heapTop = __brkval ? reinterpret_cast<const uint8_t *>(__brkval)
+		: reinterpret_cast<const uint8_t *>(&__heap_start);
+
+	// Стек растет вниз к куче, метка над кучей, которую он ни разу не затер, - неизрасходованный запас
+	const uint8_t *position = heapTop;
+	while (position <= &__stack && *position == kStackCanary) {
+		++position;
+	}
+
+	uint16_t heapFree{0};
+	for (const __freelist *block = __flp; block; block = block->nx) {
+		heapFree += block->sz + sizeof(block->sz);
+	}
+
+	aStatus.stackFree = position - heapTop;
+	aStatus.free = &stackMarker - heapTop;
+	aStatus.heapTop = reinterpret_cast<uintptr_t>(heapTop);
+	aStatus.heapFree = heapFree;
+}
+
+void watchdogInit()
+{
+	// Смена режима - за четыре такта после WDCE
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		wdt_reset();
+		WDTCSR = _BV(WDCE) | _BV(WDE);
+		WDTCSR = _BV(WDIE) | _BV(WDE) | kWatchdogPeriod;
+	}
+}
+
+void watchdogReset()
+{
+	// После прерывания сторожа выводы уже не совпадают с теневым состоянием ядра, поэтому сброс
+	// не откладывается, даже если цикл ожил: плата перезапустится и начнет с чистого состояния
+	if (watchdogMark != kWatchdogMark) {
+		wdt_reset();
+	}
+}
+
+ResetCause resetCause()
+{
+	if (resetFlags & _BV(PORF)) {
+		return ResetCause::POWER_ON;
+	} else if (resetFlags & (_BV(WDRF) | kWatchdogTripped)) {
+		return ResetCause::WATCHDOG;
+	} else if (resetFlags & _BV(BORF)) {
+		return ResetCause::BROWN_OUT;
+	} else if (resetFlags & _BV(EXTRF)) {
+		return ResetCause::EXTERNAL;
+	}
+	return ResetCause::UNKNOWN;
+}
+
+} // namespace Hal
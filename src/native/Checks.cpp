@@ -0,0 +1,424 @@
+//
+// Checks.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+#include "Board.hpp"
+#include "Checks.hpp"
+#include "Cobs.hpp"
+#include "ConfigStore.hpp"
+#include "Core.hpp"
+#include "EventLog.hpp"
+#include "FakeBoard.hpp"
+#include "Probe.hpp"
+#include "PumpPhase.hpp"
+#include "RotaryEncoder.hpp"
+#include "Settings.hpp"
+#include "Telemetry.hpp"
+#include "TimeService.hpp"
+#include "TimeContainer.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+uint32_t checks{0};
+uint32_t failures{0};
+
+void expect(bool aCondition, const char *aGroup, const char *aWhat)
+{
+	++checks;
+	if (!aCondition) {
+		++failures;
+		printf("check %s: %s FAILED\n", aGroup, aWhat);
+	}
+}
+
+// Интервал через полночь и пустой интервал
+void checkTimeWindow()
+{
+	static const char *const kGroup{"TimeWindow"};
+	const TimeWindow night{TimeContainer{22, 0}, TimeContainer{6, 0}};
+
+	expect(night.length() == 8 * 3600UL, kGroup, "length across midnight");
+	expect(night.contains(TimeContainer{22, 0}), kGroup, "contains begin");
+	expect(night.contains(TimeContainer{23, 59, 59}), kGroup, "contains before midnight");
+	expect(night.contains(TimeContainer{0, 0}), kGroup, "contains midnight");
+	expect(night.contains(TimeContainer{5, 59, 59}), kGroup, "contains last second");
+	expect(!night.contains(TimeContainer{6, 0}), kGroup, "excludes end");
+	expect(!night.contains(TimeContainer{12, 0}), kGroup, "excludes noon");
+	expect(!night.contains(TimeContainer{21, 59, 59}), kGroup, "excludes second before begin");
+	expect(night.untilChange(TimeContainer{23, 0}) == 7 * 3600UL, kGroup, "until end across midnight");
+	expect(night.untilChange(TimeContainer{12, 0}) == 10 * 3600UL, kGroup, "until begin");
+	expect(night.untilChange(TimeContainer{6, 0}) == 16 * 3600UL, kGroup, "until begin from end");
+
+	const TimeWindow empty{TimeContainer{7, 0}, TimeContainer{7, 0}};
+	expect(!empty.contains(TimeContainer{7, 0}), kGroup, "empty contains nothing");
+	expect(empty.untilChange(TimeContainer{7, 0}) == TimeContainer::kSecondsInDay, kGroup, "empty waits a day");
+}
+
+bool isPhase(const PumpPhase::Phase &aPhase, bool aFlood, uint32_t aStart, uint32_t aNext)
+{
+	return aPhase.flood == aFlood && aPhase.start == aStart && aPhase.next == aNext;
+}
+
+// Фаза от эпохи: границы фаз, время до эпохи, переполнение unixtime и перенос эпохи при смене длительности
+void checkPumpPhase()
+{
+	static const char *const kGroup{"PumpPhase"};
+	static constexpr uint32_t kEpoch{1640995200};
+	static constexpr uint32_t kFlood{600};
+	static constexpr uint32_t kDrain{1200};
+	static constexpr uint32_t kCycle{kFlood + kDrain};
+
+	expect(isPhase(PumpPhase::at(kEpoch, kEpoch, kFlood, kDrain), true, kEpoch, kEpoch + kFlood), kGroup,
+		"flood at epoch");
+	expect(isPhase(PumpPhase::at(kEpoch + kFlood - 1, kEpoch, kFlood, kDrain), true, kEpoch, kEpoch + kFlood), kGroup,
+		"flood last second");
+	expect(isPhase(PumpPhase::at(kEpoch + kFlood, kEpoch, kFlood, kDrain), false, kEpoch + kFlood, kEpoch + kCycle),
+		kGroup, "drain after flood");
+	expect(isPhase(PumpPhase::at(kEpoch + 100 * kCycle + 5, kEpoch, kFlood, kDrain), true, kEpoch + 100 * kCycle,
+		kEpoch + 100 * kCycle + kFlood), kGroup, "flood hundred cycles later");
+	expect(isPhase(PumpPhase::at(kEpoch - 1, kEpoch, kFlood, kDrain), false, kEpoch - kDrain, kEpoch), kGroup,
+		"drain before epoch");
+	expect(isPhase(PumpPhase::at(kEpoch - kCycle, kEpoch, kFlood, kDrain), true, kEpoch - kCycle,
+		kEpoch - kCycle + kFlood), kGroup, "flood a cycle before epoch");
+
+	// Эпоха перед переполнением 32 бит, момент после него
+	const uint32_t lateEpoch{0xFFFFFF00};
+	expect(isPhase(PumpPhase::at(0x100, lateEpoch, kFlood, kDrain), true, lateEpoch, lateEpoch + kFlood), kGroup,
+		"flood across overflow");
+
+	const PumpPhase::Phase idle = PumpPhase::at(kEpoch, kEpoch, 0, 0);
+	expect(!idle.flood && idle.next == kEpoch + 1, kGroup, "zero cycle");
+
+	// Новая длительность залива сохраняет начало текущей фазы
+	const PumpPhase::Phase flood = PumpPhase::at(kEpoch + 100, kEpoch, kFlood, kDrain);
+	expect(isPhase(PumpPhase::at(kEpoch + 100, PumpPhase::anchor(flood, 300), 300, kDrain), true, kEpoch,
+		kEpoch + 300), kGroup, "anchor keeps flood start");
+	const PumpPhase::Phase drain = PumpPhase::at(kEpoch + 700, kEpoch, kFlood, kDrain);
+	expect(isPhase(PumpPhase::at(kEpoch + 700, PumpPhase::anchor(drain, 300), 300, kDrain), false, kEpoch + kFlood,
+		kEpoch + kFlood + kDrain), kGroup, "anchor keeps drain start");
+}
+
+// Кольцо слотов: переход по кругу, пропуск записи без изменений, откат на прошлый слот при битой CRC,
+// чтение записи первой версии и перенос прежней записи без заголовка через запуск ядра
+void checkConfigStore()
+{
+	static const char *const kGroup{"ConfigStore"};
+	static constexpr uint8_t kHeaderSize{8};
+	static constexpr uint32_t kStartTime{1640995200};
+	using Store = ConfigStore<uint32_t, kSettingsAddress, kSettingsSlots, kSettingsSlotSize>;
+
+	FakeBoard::reset(kStartTime);
+	uint32_t value{0};
+	uint8_t version{0};
+	expect(!Store{}.load(value, version), kGroup, "erased EEPROM has no record");
+
+	Store store;
+	static constexpr uint32_t kSaves{kSettingsSlots + 3};
+	for (uint32_t i = 1; i <= kSaves; ++i) {
+		store.save(i, 1);
+	}
+	store.save(kSaves, 1);
+	expect(store.sequence() == kSaves, kGroup, "unchanged record is not written");
+	expect(Store{}.load(value, version) && value == kSaves && version == 1, kGroup, "newest record after wrap");
+
+	const uint16_t newest = kSettingsAddress + ((kSaves - 1) % kSettingsSlots) * kSettingsSlotSize;
+	FakeBoard::eeprom()[newest + kHeaderSize] ^= 0x01;
+	expect(Store{}.load(value, version) && value == kSaves - 1, kGroup, "corrupt CRC falls back to previous slot");
+
+	Store reloaded;
+	reloaded.load(value, version);
+	reloaded.save(100, 1);
+	expect(Store{}.load(value, version) && value == 100, kGroup, "save after fallback");
+
+	// Запись первой версии короче текущей схемы, хвост приходит стертым
+	struct SettingsV1 {
+		uint8_t bytes[kSettingsV1Size];
+	};
+	FakeBoard::reset(kStartTime);
+	SettingsV1 v1;
+	memset(&v1, 0x11, sizeof(v1));
+	ConfigStore<SettingsV1, kSettingsAddress, kSettingsSlots, kSettingsSlotSize>{}.save(v1, 1);
+
+	EepromData data;
+	bool erasedTail{true};
+	expect(SettingsStore{}.load(data, version) && version == 1 && !memcmp(&data, &v1, sizeof(v1)), kGroup,
+		"v1 record loads as prefix");
+	for (size_t i = sizeof(v1); i < sizeof(data); ++i) {
+		erasedTail = erasedTail && reinterpret_cast<const uint8_t *>(&data)[i] == 0xFF;
+	}
+	expect(erasedTail, kGroup, "v1 record tail is erased");
+
+	// Прежняя запись без заголовка по адресу 0 переносится в кольцо текущей версии
+	FakeBoard::reset(kStartTime);
+	EepromData legacy;
+	memset(&legacy, 0xFF, sizeof(legacy));
+	legacy.pumpOnPeriod = 20;
+	legacy.pumpOffPeriod = 30;
+	legacy.lampOnTime = TimeContainerMinimal{6, 15};
+	legacy.lampOffTime = TimeContainerMinimal{21, 45};
+	legacy.swingOffPeriod = 5;
+	legacy.hydroType = HydroTypes::NORMAL;
+	legacy.maxTimeForFullFlood = 90;
+	memcpy(FakeBoard::eeprom(), &legacy, kSettingsV1Size);
+	FakeBoard::setInput(kFloatLevelPin, false); // Поплавок подключен, иначе запуск посчитает ошибку
+
+	coreSetup();
+	coreLoop();
+	expect(SettingsStore{}.load(data, version) && version == kSettingsVersion, kGroup, "legacy record migrated");
+	expect(data.pumpOnPeriod == 20 && data.pumpOffPeriod == 30 && data.lampOnTime.hours == 6
+		&& data.lampOnTime.minutes == 15 && data.lampOffTime.hours == 21 && data.lampOffTime.minutes == 45
+		&& data.swingOffPeriod == 5 && data.hydroType == HydroTypes::NORMAL && data.maxTimeForFullFlood == 90,
+		kGroup, "legacy fields kept");
+	expect(data.lampPeriods[0].on.hours == 0 && data.sunriseTime == 0 && data.sunsetTime == 0
+		&& data.pumpEpoch != PumpPhase::kNoEpoch && !data.pumpLocked
+		&& !memcmp(&data.phCalibration, &Probe::kPhDefault, sizeof(data.phCalibration))
+		&& !data.floodCycles && !data.errors, kGroup,
+		"new fields filled");
+}
+
+// Голова журнала ищется по биту круга: после любого числа записей, в том числе на границе круга
+// и после нескольких кругов, новый экземпляр продолжает с нужного места, а чтение идет подряд
+// от самой старой уцелевшей записи к самой новой
+void checkEventLog()
+{
+	static const char *const kGroup{"EventLog"};
+	static constexpr uint32_t kStartTime{1640995200};
+	static constexpr uint32_t kStep{10};
+	using Log = EventLog<kLogAddress, 64>;
+	static constexpr uint16_t kMaxEvents{Log::kCapacity * 3 + 2};
+	static_assert(kMaxEvents <= UINT8_MAX, "Argument is the event number");
+
+	bool resumed{true};
+	bool ordered{true};
+	bool timed{true};
+	bool filled{true};
+
+	for (uint16_t count = 0; count <= kMaxEvents; ++count) {
+		FakeBoard::reset(kStartTime);
+
+		// count записей одним экземпляром, последняя - другим, как после перезагрузки
+		Log before;
+		before.begin();
+		for (uint16_t i = 0; i < count; ++i) {
+			before.append(static_cast<uint8_t>(i % 64), static_cast<uint8_t>(i), kStartTime + kStep * i);
+		}
+		Log after;
+		after.begin();
+		after.append(static_cast<uint8_t>(count % 64), static_cast<uint8_t>(count), kStartTime + kStep * count);
+
+		Log reader;
+		reader.begin();
+		Log::Cursor cursor;
+		Log::Entry entry{0, 0, 0, false};
+		uint16_t entries{0};
+		uint8_t expected{0};
+		reader.rewind(cursor);
+
+		while (reader.next(cursor, entry)) {
+			ordered = ordered && (!entries || entry.argument == expected);
+			expected = entry.argument + 1;
+			timed = timed && (!entry.timeKnown || entry.time == kStartTime + kStep * entry.argument);
+			++entries;
+		}
+		resumed = resumed && entries && entry.argument == count;
+		// Служебных записей времени на круге не больше трех: после старта, после перезагрузки и по интервалу
+		filled = filled && entries >= (count + 1 < Log::kCapacity - 3 ? count + 1 : Log::kCapacity - 3);
+	}
+
+	expect(resumed, kGroup, "newest entry after restart");
+	expect(ordered, kGroup, "entries in order across lap and wrap");
+	expect(timed, kGroup, "entry times");
+	expect(filled, kGroup, "ring keeps the newest entries");
+}
+
+// Круг кодирования COBS: без нулей на выходе, в пределах maxEncodedSize и обратно без потерь. Данные
+// без нулей и с нулями на границе блока в 254 байта, где кодер закрывает блок без нуля
+void checkCobs()
+{
+	static const char *const kGroup{"Cobs"};
+	static constexpr size_t kMaxSize{600};
+	static const size_t kSizes[] = {0, 1, 2, 253, 254, 255, 256, 507, 508, 509, 510, kMaxSize};
+	static const size_t kZeroPositions[] = {0, 252, 253, 254, 255, 507, 508};
+
+	uint8_t data[kMaxSize];
+	uint8_t encoded[Cobs::maxEncodedSize(kMaxSize)];
+	uint8_t decoded[kMaxSize];
+	bool noZeros{true};
+	bool bounded{true};
+	bool restored{true};
+
+	// Шаблон 0 - без нулей, 1 - одни нули, дальше - серия из 1..3 нулей с позиции из kZeroPositions
+	for (size_t size : kSizes) {
+		for (uint8_t pattern = 0; pattern < 2 + 3 * sizeof(kZeroPositions) / sizeof(kZeroPositions[0]); ++pattern) {
+			for (size_t i = 0; i < size; ++i) {
+				data[i] = pattern == 1 ? 0 : static_cast<uint8_t>(i % 255 + 1);
+			}
+			if (pattern >= 2) {
+				const size_t position = kZeroPositions[(pattern - 2) / 3];
+				for (size_t i = position; i < position + (pattern - 2) % 3 + 1 && i < size; ++i) {
+					data[i] = 0;
+				}
+			}
+
+			const size_t length = Cobs::encode(data, size, encoded);
+			size_t decodedSize;
+			bounded = bounded && length <= Cobs::maxEncodedSize(size);
+			noZeros = noZeros && !memchr(encoded, 0, length);
+			restored = restored && Cobs::decode(encoded, length, decoded, decodedSize) && decodedSize == size
+				&& !memcmp(data, decoded, size);
+		}
+	}
+
+	expect(noZeros, kGroup, "no zeros in encoded data");
+	expect(bounded, kGroup, "encoded size within maxEncodedSize");
+	expect(restored, kGroup, "round trip");
+
+	// Ноль внутри кодированных данных или счетчик за концом - испорченный кадр
+	const uint8_t zeroInside[] = {0x03, 0x11, 0x00};
+	const uint8_t pastEnd[] = {0x05, 0x11, 0x22};
+	size_t decodedSize;
+	expect(!Cobs::decode(zeroInside, sizeof(zeroInside), decoded, decodedSize), kGroup, "zero inside rejected");
+	expect(!Cobs::decode(pastEnd, sizeof(pastEnd), decoded, decodedSize), kGroup, "block past end rejected");
+}
+
+// Упакованные снимок и событие ровно той длины, под которую прошивка заводит буфер, и разбираются обратно
+void checkTelemetry()
+{
+	static const char *const kGroup{"Telemetry"};
+	const Telemetry::Snapshot snapshot{0x01020304, 1640995200, 0x81, 200, 1, 3, 7, 9, 123456, 1500, 2, 652, 1400,
+		-105, 300, 12};
+	uint8_t payload[Telemetry::kMaxPayload];
+	uint8_t repacked[Telemetry::kMaxPayload];
+	Telemetry::Snapshot unpacked;
+
+	// Разобранный снимок, упакованный заново, совпадает побайтно: ни одно поле не потерялось
+	expect(Telemetry::pack(snapshot, payload) == Telemetry::kSnapshotSize, kGroup, "snapshot size");
+	expect(Telemetry::unpack(payload, Telemetry::kSnapshotSize, unpacked)
+		&& Telemetry::pack(unpacked, repacked) == Telemetry::kSnapshotSize
+		&& !memcmp(payload, repacked, Telemetry::kSnapshotSize), kGroup, "snapshot round trip");
+	expect(!Telemetry::unpack(payload, Telemetry::kSnapshotSize - 1, unpacked), kGroup, "short snapshot rejected");
+
+	const Telemetry::Event event{1640995200, 5, 17};
+	Telemetry::Event unpackedEvent;
+	expect(Telemetry::pack(event, payload) == Telemetry::kEventSize, kGroup, "event size");
+	expect(Telemetry::unpack(payload, Telemetry::kEventSize, unpackedEvent) && unpackedEvent.time == event.time
+		&& unpackedEvent.type == event.type && unpackedEvent.argument == event.argument, kGroup, "event round trip");
+}
+
+// Калибровка с близкими точками отбрасывается, термокомпенсация крайних значений не переполняется
+void checkProbe()
+{
+	static const char *const kGroup{"Probe"};
+
+	expect(Probe::valid(Probe::kPhDefault) && Probe::valid(Probe::kEcDefault), kGroup, "defaults valid");
+	expect(!Probe::valid(ProbeCalibration{{8192, 8193}, {400, 700}}), kGroup, "close points rejected");
+	expect(!Probe::valid(ProbeCalibration{{8193, 8192 - Probe::kMinRawSpan + 2}, {400, 700}}), kGroup,
+		"close points rejected in reverse");
+	expect(Probe::valid(ProbeCalibration{{8192 + Probe::kMinRawSpan, 8192}, {400, 700}}), kGroup, "minimal span");
+
+	// Самый крутой наклон, который пропускает valid(), на краю шкалы АЦП
+	const ProbeCalibration steep{{0, Probe::kMinRawSpan}, {INT16_MIN, INT16_MAX}};
+	const int32_t ec = Probe::apply(steep, Probe::kAdcFullScale - 1);
+	expect(ec > 0 && Probe::compensateEc(ec, 0) > Probe::kMaxEc, kGroup, "cold extreme without overflow");
+	expect(Probe::compensateEc(ec, 1000) > 0 && Probe::compensateEc(-ec, 1000) < 0, kGroup,
+		"hot extreme without overflow");
+	expect(Probe::compensateEc(1413, Probe::kReferenceTemperature) == 1413, kGroup, "reference temperature");
+}
+
+// Полный шаг энкодера: четыре перехода выводов A и B от детента к детенту
+void turn(RotaryEncoder &aEncoder, bool aClockwise, uint32_t &aNow)
+{
+	static const uint8_t kSequence[] = {0x01, 0x00, 0x02, 0x03}; // A << 1 | B
+
+	for (uint8_t state : kSequence) {
+		const uint8_t phase = aClockwise ? state : static_cast<uint8_t>(((state & 1) << 1) | (state >> 1));
+		aEncoder.onChange(phase & 0x02, phase & 0x01, true, ++aNow);
+	}
+}
+
+// События выходят в порядке поступления: нажатие посреди вращения не обгоняет шаги перед ним,
+// длинная серия шагов в одну сторону не теряется
+void checkRotaryEncoder()
+{
+	static const char *const kGroup{"RotaryEncoder"};
+	static constexpr uint16_t kLongTurn{300};
+	RotaryEncoder encoder;
+	uint32_t now{0};
+
+	encoder.begin(true, true, true);
+	for (uint16_t i = 0; i < kLongTurn; ++i) {
+		turn(encoder, true, now);
+	}
+	encoder.onChange(true, true, false, now += 50);
+	encoder.onChange(true, true, true, now += 50);
+	turn(encoder, false, now);
+	turn(encoder, false, now);
+
+	EncoderEvent event;
+	uint16_t firstSteps{0};
+	bool ordered{true};
+	while (encoder.pop(event, true, now) && event.type != EncoderEvent::Type::PRESS) {
+		ordered = ordered && event.type == EncoderEvent::Type::RIGHT;
+		++firstSteps;
+	}
+	expect(ordered && firstSteps == kLongTurn && event.type == EncoderEvent::Type::PRESS, kGroup,
+		"steps before press");
+
+	uint8_t backSteps{0};
+	while (encoder.pop(event, true, now)) {
+		ordered = ordered && event.type == EncoderEvent::Type::LEFT;
+		++backSteps;
+	}
+	expect(ordered && backSteps == 2, kGroup, "steps after press");
+}
+
+// Запуск без ответа RTC не зависает: ошибка в журнале, время идет по millis от времени сборки,
+// а после срока синхронизации чтение повторяется не чаще раза в TimeService::kRetryDelay
+void checkRtcMissing()
+{
+	static const char *const kGroup{"RtcMissing"};
+	static constexpr uint32_t kStartTime{1640995200 + 12 * 3600}; // Время сборки в хостовой сборке - время reset()
+
+	FakeBoard::reset(kStartTime);
+	FakeBoard::setRtcMissing(true);
+	FakeBoard::setInput(kFloatLevelPin, false);
+	coreSetup();
+	expect(FakeBoard::eventCount(LogEvents::RTC_FAILED) == 1, kGroup, "error logged");
+
+	static constexpr uint32_t kSeconds{3660};
+	const uint32_t setupRequests = FakeBoard::rtcRequests();
+	for (uint32_t second = 0; second < kSeconds; ++second) {
+		FakeBoard::advance(1000);
+		coreLoop();
+	}
+	expect(!strcmp(FakeBoard::displayLine(1), "13:01"), kGroup, "time goes by millis");
+	expect(FakeBoard::rtcRequests() - setupRequests <= kSeconds * 1000 / TimeService::kRetryDelay + 1, kGroup,
+		"retries paced");
+}
+
+} // namespace
+
+namespace Checks {
+
+uint32_t run()
+{
+	checkTimeWindow();
+	checkPumpPhase();
+	checkConfigStore();
+	checkEventLog();
+	checkCobs();
+	checkTelemetry();
+	checkProbe();
+	checkRotaryEncoder();
+	checkRtcMissing();
+
+	printf("%u checks, %u failed\n", checks, failures);
+	return failures;
+}
+
+} // namespace Checks
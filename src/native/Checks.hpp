@@ -0,0 +1,19 @@
+//
+// Checks.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Проверки отдельных модулей без прогона ядра: граничные случаи, которые суточный перебор сценариев
+// задевает редко или не задевает вовсе. Каждая несошедшаяся проверка печатается
+
+#pragma once
+
+#include <stdint.h>
+
+namespace Checks {
+
+uint32_t run(); // Число проваленных проверок
+
+} // namespace Checks
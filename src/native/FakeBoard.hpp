@@ -0,0 +1,44 @@
+//
+// FakeBoard.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Управление фейковым железом хостовой сборки: часы, RTC, пины, EEPROM и экран живут в памяти
+
+#pragma once
+
+#include "Hal.hpp"
+#include "LogEvents.hpp"
+#include <stdint.h>
+
+namespace FakeBoard {
+
+static constexpr uint8_t kPinCount{20};
+static constexpr uint16_t kEepromSize{1024};
+
+void reset(uint32_t aUnixTime);
+void advance(uint32_t aMilliseconds);
+uint32_t pendingTime(); // Миллисекунд до окончания выдержки поплавка, UINT32_MAX - выдержка не идет
+
+void setInput(uint8_t aPin, bool aLevel);
+bool output(uint8_t aPin);
+uint16_t lampDuty();
+void setAnalog(Hal::AdcChannel aChannel, uint16_t aValue); // Уровень на входе АЦП, 0..1023
+
+uint8_t *eeprom();
+const char *displayLine(uint8_t aLine);
+uint32_t displayFlushes();
+
+void setLogEnabled(bool aEnabled);
+void logInput(char aChar); // Символ, принятый по линии отладки
+void setTelemetryOutput(int aFd); // Дескриптор для кадров телеметрии, -1 - никуда
+uint32_t telemetryFrames(); // Кадров с reset()
+void setMemoryStatus(const Hal::MemoryStatus &aStatus); // То, что вернет Hal::memoryStatus()
+uint32_t eventCount(LogEvents aEvent); // Событий этого типа в телеметрии с reset()
+void setResetCause(Hal::ResetCause aCause); // То, что вернет Hal::resetCause(), после reset() - POWER_ON
+void setRtcMissing(bool aMissing); // RTC не отвечает на шине, после reset() - отвечает
+uint32_t rtcRequests(); // Запросов чтения RTC с reset()
+
+} // namespace FakeBoard
@@ -0,0 +1,519 @@
+//
+// HalNative.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Реализация HAL на фейках в памяти для сборки и прогона логики на Linux
+
+#include "Board.hpp"
+#include "FakeBoard.hpp"
+#include "Hal.hpp"
+#include "LogEvents.hpp"
+#include "RingBuffer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+struct State {
+	uint32_t millis;
+	uint64_t clock;          // Миллисекунды с reset(), в отличие от millis не переполняются
+	uint32_t rtcBase;        // unixtime на момент последней записи RTC
+	uint64_t rtcBaseClock;   // clock на момент последней записи RTC
+	uint32_t rtcBaseTicks;   // Секундные метки SQW на момент последней записи RTC
+	bool rtcMissing;         // RTC не отвечает на шине
+	uint32_t rtcRequests;    // Запросов чтения RTC с reset()
+	bool levels[FakeBoard::kPinCount];
+	Hal::PinMode modes[FakeBoard::kPinCount];
+	uint8_t eeprom[FakeBoard::kEepromSize];
+	uint32_t floatChangeMillis; // Последний фронт поплавка, с него идет выдержка
+	uint8_t floatDebounceTime;
+	bool floatPending;
+	bool floatStable;
+	bool floatCutoff;
+	uint16_t lampDuty;
+	uint16_t analog[static_cast<uint8_t>(Hal::AdcChannel::COUNT)]; // Уровни на входах АЦП, 10 бит
+	uint32_t adcMillis; // Время последней порции значений АЦП
+	bool adcRunning;
+	char lines[2][22];
+	uint32_t flushes;
+	bool log;
+	uint8_t telemetrySequence;
+	uint32_t telemetryFrames;
+	Hal::MemoryStatus memory;
+	Hal::ResetCause resetCause;
+	uint32_t events[static_cast<uint8_t>(LogEvents::COUNT)]; // Событий в телеметрии по типам
+};
+
+State state;
+RingBuffer<bool, 4> floatEvents;
+RingBuffer<char, 16> logChars;
+static constexpr uint8_t kAdcQueueSize{16};
+RingBuffer<Hal::AdcSample, kAdcQueueSize> adcSamples;
+RotaryEncoder encoder;
+int telemetryOutput{-1}; // Переживает reset(), как и флаг лога
+
+// По значению на канал за период задачи датчиков. На плате значений в несколько раз больше,
+// но уровни здесь постоянные, а прогон сценариев должен оставаться быстрым
+static constexpr uint32_t kAdcPeriod{250};
+// Сколько периодов помещается в очередь: после долгого шага часов более старые значения все равно потерялись бы
+static constexpr uint32_t kAdcBacklog{kAdcPeriod * (kAdcQueueSize / static_cast<uint8_t>(Hal::AdcChannel::COUNT))};
+
+// Вместо прерывания АЦП: значения досчитываются при продвижении часов
+void adcService()
+{
+	if (!state.adcRunning) {
+		return;
+	}
+
+	if (state.millis - state.adcMillis > kAdcBacklog) {
+		state.adcMillis = state.millis - kAdcBacklog;
+	}
+	while (state.millis - state.adcMillis >= kAdcPeriod) {
+		state.adcMillis += kAdcPeriod;
+		for (uint8_t channel = 0; channel < static_cast<uint8_t>(Hal::AdcChannel::COUNT); ++channel) {
+			adcSamples.push(Hal::AdcSample{static_cast<Hal::AdcChannel>(channel),
+				static_cast<uint16_t>(state.analog[channel] << (Hal::kAdcBits - 10))});
+		}
+	}
+}
+
+// Вместо прерывания таймера: выдержка досчитывается при продвижении часов
+void floatService()
+{
+	if (!state.floatPending || state.millis - state.floatChangeMillis < state.floatDebounceTime) {
+		return;
+	}
+
+	state.floatPending = false;
+	const bool level = state.levels[kFloatLevelPin];
+	if (level == state.floatStable) {
+		return;
+	}
+
+	state.floatStable = level;
+	if (level && state.floatCutoff) {
+		Hal::portWrite(pinPort(kPumpPin), pinMask(kPumpPin), 0);
+		state.floatCutoff = false;
+	}
+	floatEvents.push(level);
+}
+
+} // namespace
+
+namespace FakeBoard {
+
+void reset(uint32_t aUnixTime)
+{
+	const bool log = state.log;
+	memset(&state, 0, sizeof(state));
+	memset(state.eeprom, 0xFF, sizeof(state.eeprom));
+	state.rtcBase = aUnixTime;
+	state.log = log;
+	floatEvents.clear();
+	logChars.clear();
+	adcSamples.clear();
+
+	// Раствор на столе: pH около 7, проводимость около 1.2 мСм/см, 25 градусов
+	setAnalog(Hal::AdcChannel::PH, 512);
+	setAnalog(Hal::AdcChannel::EC, 42);
+	setAnalog(Hal::AdcChannel::TEMPERATURE, 512);
+
+	// Примерно как у прошивки на ATmega328: статические данные до 0x0500, запаса с килобайт
+	state.memory = Hal::MemoryStatus{1024, 1100, 0x0500, 0};
+	state.resetCause = Hal::ResetCause::POWER_ON;
+
+	for (uint8_t pin = 0; pin < FakeBoard::kPinCount; ++pin) {
+		state.levels[pin] = true; // Входы с подтяжкой
+		state.modes[pin] = Hal::PinMode::IN_PULLUP;
+	}
+}
+
+void advance(uint32_t aMilliseconds)
+{
+	state.millis += aMilliseconds;
+	state.clock += aMilliseconds;
+	floatService();
+	adcService();
+}
+
+uint32_t pendingTime()
+{
+	if (!state.floatPending) {
+		return UINT32_MAX;
+	}
+
+	const uint32_t elapsed = state.millis - state.floatChangeMillis;
+	return elapsed < state.floatDebounceTime ? state.floatDebounceTime - elapsed : 0;
+}
+
+void setInput(uint8_t aPin, bool aLevel)
+{
+	if (aPin == kFloatLevelPin && aLevel != state.levels[aPin]) {
+		state.floatChangeMillis = state.millis;
+		state.floatPending = true;
+	}
+	state.levels[aPin] = aLevel;
+
+	if (aPin == kEncS1Pin || aPin == kEncS2Pin || aPin == kEncKeyPin) {
+		encoder.onChange(state.levels[kEncS1Pin], state.levels[kEncS2Pin], state.levels[kEncKeyPin], state.millis);
+	}
+}
+
+bool output(uint8_t aPin)
+{
+	return state.modes[aPin] == Hal::PinMode::OUT && state.levels[aPin];
+}
+
+uint16_t lampDuty()
+{
+	return state.lampDuty;
+}
+
+void setAnalog(Hal::AdcChannel aChannel, uint16_t aValue)
+{
+	state.analog[static_cast<uint8_t>(aChannel)] = aValue;
+}
+
+uint8_t *eeprom()
+{
+	return state.eeprom;
+}
+
+const char *displayLine(uint8_t aLine)
+{
+	return state.lines[aLine];
+}
+
+uint32_t displayFlushes()
+{
+	return state.flushes;
+}
+
+void setLogEnabled(bool aEnabled)
+{
+	state.log = aEnabled;
+}
+
+void logInput(char aChar)
+{
+	logChars.push(aChar);
+}
+
+void setTelemetryOutput(int aFd)
+{
+	telemetryOutput = aFd;
+}
+
+void setMemoryStatus(const Hal::MemoryStatus &aStatus)
+{
+	state.memory = aStatus;
+}
+
+void setResetCause(Hal::ResetCause aCause)
+{
+	state.resetCause = aCause;
+}
+
+void setRtcMissing(bool aMissing)
+{
+	state.rtcMissing = aMissing;
+}
+
+uint32_t rtcRequests()
+{
+	return state.rtcRequests;
+}
+
+uint32_t telemetryFrames()
+{
+	return state.telemetryFrames;
+}
+
+uint32_t eventCount(LogEvents aEvent)
+{
+	return state.events[static_cast<uint8_t>(aEvent)];
+}
+
+} // namespace FakeBoard
+
+namespace Hal {
+
+void gpioMode(uint8_t aPin, PinMode aMode)
+{
+	if (aMode == PinMode::OUT && state.modes[aPin] != PinMode::OUT) {
+		state.levels[aPin] = false;
+	}
+	state.modes[aPin] = aMode;
+}
+
+void gpioWrite(uint8_t aPin, bool aState)
+{
+	if (state.modes[aPin] == PinMode::OUT) {
+		state.levels[aPin] = aState;
+	}
+}
+
+bool gpioRead(uint8_t aPin)
+{
+	return state.levels[aPin];
+}
+
+void portWrite(Port aPort, uint8_t aMask, uint8_t aValue)
+{
+	for (uint8_t pin = 0; pin < FakeBoard::kPinCount; ++pin) {
+		if (pinPort(pin) == aPort && (aMask & pinMask(pin))) {
+			gpioWrite(pin, aValue & pinMask(pin));
+		}
+	}
+}
+
+uint32_t millis()
+{
+	return state.millis;
+}
+
+uint32_t micros()
+{
+	return state.millis * 1000;
+}
+
+uint32_t ticks()
+{
+	return state.millis * (1000 / Hal::kTickMicros);
+}
+
+void rtcInit()
+{
+}
+
+// Внутреннее чтение фейкового RTC, снаружи время доступно через rtcRequest()/rtcResult()
+static uint32_t rtcRead()
+{
+	return state.rtcBase + static_cast<uint32_t>((state.clock - state.rtcBaseClock) / 1000);
+}
+
+void rtcWrite(uint32_t aUnixTime)
+{
+	if (state.rtcMissing) {
+		return;
+	}
+
+	// Запись секунд в DS3231 перезапускает делитель, следующая метка через секунду
+	state.rtcBaseTicks = rtcTicks();
+	state.rtcBase = aUnixTime;
+	state.rtcBaseClock = state.clock;
+}
+
+void rtcTickInit()
+{
+}
+
+uint32_t rtcTicks()
+{
+	return state.rtcBaseTicks + static_cast<uint32_t>((state.clock - state.rtcBaseClock) / 1000);
+}
+
+bool rtcRequest()
+{
+	++state.rtcRequests;
+	return true;
+}
+
+RtcStatus rtcResult(uint32_t &aUnixTime, uint32_t &aTicks)
+{
+	if (state.rtcMissing) {
+		return RtcStatus::FAILED; // Адрес без ACK
+	}
+
+	aUnixTime = rtcRead();
+	aTicks = rtcTicks();
+	return RtcStatus::DONE;
+}
+
+uint32_t buildTime()
+{
+	return state.rtcBase;
+}
+
+void floatInit(uint8_t aDebounceTime)
+{
+	state.floatDebounceTime = aDebounceTime;
+	state.floatPending = false;
+	state.floatCutoff = false;
+	state.floatStable = state.levels[kFloatLevelPin];
+}
+
+bool floatLevel()
+{
+	return state.floatStable;
+}
+
+bool floatEvent(bool &aLevel)
+{
+	return floatEvents.pop(aLevel);
+}
+
+void floatCutoff(bool aArmed)
+{
+	state.floatCutoff = aArmed;
+}
+
+void encoderInit()
+{
+	encoder.begin(state.levels[kEncS1Pin], state.levels[kEncS2Pin], state.levels[kEncKeyPin]);
+}
+
+bool encoderEvent(EncoderEvent &aEvent)
+{
+	return encoder.pop(aEvent, state.levels[kEncKeyPin], state.millis);
+}
+
+void lampPwmInit()
+{
+	gpioMode(kLampDimPin, PinMode::OUT);
+	state.lampDuty = 0;
+}
+
+void lampPwm(uint16_t aDuty)
+{
+	state.lampDuty = aDuty;
+}
+
+void adcInit()
+{
+	adcSamples.clear();
+	state.adcMillis = state.millis;
+	state.adcRunning = true;
+}
+
+bool adcSample(AdcSample &aSample)
+{
+	return adcSamples.pop(aSample);
+}
+
+void eepromRead(uint16_t aAddress, void *aData, size_t aSize)
+{
+	memcpy(aData, state.eeprom + aAddress, aSize);
+}
+
+void eepromUpdate(uint16_t aAddress, const void *aData, size_t aSize)
+{
+	memcpy(state.eeprom + aAddress, aData, aSize);
+}
+
+void displayInit()
+{
+	displayClear();
+}
+
+void displayClear()
+{
+	memset(state.lines, 0, sizeof(state.lines));
+}
+
+void displayPrint(uint8_t, uint8_t aY, const char *aText)
+{
+	char *line = state.lines[aY < 16 ? 0 : 1];
+	strncat(line, aText, sizeof(state.lines[0]) - strlen(line) - 1);
+}
+
+void displayFlush()
+{
+	++state.flushes;
+}
+
+void displayRefresh()
+{
+}
+
+void displayService()
+{
+}
+
+bool displayBusy()
+{
+	return false;
+}
+
+void telemetryInit()
+{
+}
+
+// Кадры собираются как на плате и уходят в заданный дескриптор, например в pty. Порт не теряет
+// кадры, запись ждет, пока приемник не заберет данные. Без дескриптора кадр только считается,
+// сборка кадра на каждый снимок заметно замедляет прогон сценариев
+bool telemetry(Telemetry::Type aType, const void *aPayload, uint8_t aSize)
+{
+	const uint8_t sequence = state.telemetrySequence++;
+	++state.telemetryFrames;
+
+	if (telemetryOutput >= 0) {
+		uint8_t frame[Telemetry::kMaxFrameSize];
+		const uint8_t size = Telemetry::frame(aType, sequence, aPayload, aSize, frame);
+
+		for (uint8_t written = 0; written < size;) {
+			const ssize_t result = write(telemetryOutput, frame + written, size - written);
+			if (result <= 0) {
+				break;
+			}
+			written += static_cast<uint8_t>(result);
+		}
+	}
+
+	Telemetry::Event event;
+	if (aType == Telemetry::Type::EVENT && Telemetry::unpack(static_cast<const uint8_t *>(aPayload), aSize, event)) {
+		if (event.type < static_cast<uint8_t>(LogEvents::COUNT)) {
+			++state.events[event.type];
+		}
+		if (state.log) {
+			printf("[%10u] event %s %u\n", event.time,
+				event.type < static_cast<uint8_t>(LogEvents::COUNT) ? kLogEventNames[event.type] : "?", event.argument);
+		}
+	}
+	return true;
+}
+
+uint16_t telemetryDropped()
+{
+	return 0;
+}
+
+void log(const char *aText)
+{
+	telemetry(Telemetry::Type::TEXT, aText, static_cast<uint8_t>(strnlen(aText, Telemetry::kMaxPayload)));
+	if (state.log) {
+		printf("[%10u] %s\n", rtcRead(), aText);
+	}
+}
+
+bool logRead(char &aChar)
+{
+	return logChars.pop(aChar);
+}
+
+void memoryStatus(MemoryStatus &aStatus)
+{
+	aStatus = state.memory;
+}
+
+// Главный цикл хостовой сборки не зависает, сторож только для совпадения интерфейса
+void watchdogInit()
+{
+
+}
+
+void watchdogReset()
+{
+
+}
+
+ResetCause resetCause()
+{
+	return state.resetCause;
+}
+
+} // namespace Hal
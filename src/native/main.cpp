@@ -0,0 +1,179 @@
+//
+// main.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Хостовый прогон логики: перебирает настройки насоса и режимы, гоняет ядро по суткам
+// на фейковом железе и печатает сводку по каждому сценарию. Часы переводятся сразу к ближайшему
+// событию: сроку задач выходов ядра, окончанию выдержки поплавка или переходу уровня камеры.
+// Перед перебором идут проверки отдельных модулей (Checks.cpp). Код возврата ненулевой, если хоть
+// одна проверка или один сценарий не прошли
+
+#include "Board.hpp"
+#include "Checks.hpp"
+#include "Core.hpp"
+#include "FakeBoard.hpp"
+#include "Hal.hpp"
+#include "LogEvents.hpp"
+#include "PumpPhase.hpp"
+#include "Settings.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+namespace {
+
+static constexpr uint32_t kStartTime{1640995200}; // 01.01.2022 00:00:00
+static constexpr uint32_t kDuration{86400}; // Секунды
+static constexpr uint16_t kFillSeconds{40}; // Время заполнения камеры в упрощенной модели
+static constexpr uint32_t kRebootTime{37237}; // Перезагрузка посреди суток, секунды от начала прогона
+static constexpr uint16_t kLeakFillSeconds{200}; // Камера с протечкой заполняется дольше допустимого времени залива
+
+struct Result {
+	uint32_t pumpSeconds;
+	uint32_t pumpStarts;
+	uint32_t loops; // Проходов ядра за сутки
+	bool locked; // Насос заблокирован критической ошибкой
+	uint32_t lockedAt; // Секунда прогона
+	uint32_t pumpAfterLock; // Миллисекунд работы насоса после блокировки, должно быть 0
+};
+
+uint32_t earliest(uint32_t aFirst, uint32_t aSecond)
+{
+	return aFirst < aSecond ? aFirst : aSecond;
+}
+
+// Упрощенная камера: уровень в миллисекундах налива растет, пока работает насос, и падает, пока он
+// стоит. Поплавок срабатывает на полной камере. aRebootAt - секунда прогона, в которую ядро
+// перезапускается как после пропадания питания, 0 - без перезагрузки
+Result runScenario(const EepromData &aSettings, uint32_t aRebootAt = 0, uint16_t aFillSeconds = kFillSeconds)
+{
+	Result result{0, 0, 0, false, 0, 0};
+	const uint32_t full = aFillSeconds * 1000UL;
+	const uint32_t end = kDuration * 1000;
+	uint32_t level{0};
+	uint32_t pumpMs{0};
+	uint32_t now{0};
+	bool pump{false};
+	bool rebooted{aRebootAt == 0};
+
+	FakeBoard::reset(kStartTime);
+	SettingsStore{}.save(aSettings, kSettingsVersion);
+	FakeBoard::setInput(kFloatLevelPin, false);
+
+	coreSetup();
+
+	while (now < end) {
+		const int32_t wait = static_cast<int32_t>(coreNextDeadline() - Hal::millis());
+		uint32_t step = wait > 0 ? static_cast<uint32_t>(wait) : 0;
+
+		step = earliest(step, FakeBoard::pendingTime());
+		if (pump && level < full) {
+			step = earliest(step, full - level);
+		} else if (!pump && level >= full) {
+			step = earliest(step, level - full + 1);
+		}
+		if (!rebooted) {
+			step = earliest(step, aRebootAt * 1000 - now);
+		}
+		step = earliest(step, end - now);
+		step = step ? step : 1;
+
+		FakeBoard::advance(step);
+		now += step;
+
+		if (pump) {
+			pumpMs += step;
+			result.pumpAfterLock += result.locked ? step : 0;
+			level = earliest(level + step, full);
+		} else {
+			level = level > step ? level - step : 0;
+		}
+		FakeBoard::setInput(kFloatLevelPin, level >= full);
+
+		if (!rebooted && now == aRebootAt * 1000) {
+			FakeBoard::setResetCause(Hal::ResetCause::EXTERNAL);
+			coreSetup(); // EEPROM и RTC сохраняются, насос и остальные выходы начинают с нуля
+			rebooted = true;
+		}
+		coreLoop();
+		++result.loops;
+
+		const bool output = FakeBoard::output(kPumpPin);
+		if (output && !pump) {
+			++result.pumpStarts;
+		}
+		pump = output;
+
+		if (!result.locked && FakeBoard::eventCount(LogEvents::PUMP_LOCKED)) {
+			result.locked = true;
+			result.lockedAt = now / 1000;
+		}
+	}
+
+	result.pumpSeconds = pumpMs / 1000;
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	FakeBoard::setLogEnabled(argc > 1 && !strcmp(argv[1], "-v"));
+
+	uint32_t scenarios{0};
+	uint32_t locks{0};
+	uint32_t rebootMismatches{0};
+	const uint32_t checkFailures = Checks::run();
+	uint32_t failures{0};
+	uint64_t loops{0};
+	const auto start = std::chrono::steady_clock::now();
+
+	for (auto type : {HydroTypes::NORMAL, HydroTypes::SWING}) {
+		for (uint8_t flood = 5; flood <= 60; flood += 5) {
+			for (uint8_t drain = 5; drain <= 60; drain += 5) {
+				const EepromData settings{flood, drain, {7, 0}, {23, 30}, 10, type, 120, {}, 0, 0, PumpPhase::kNoEpoch,
+					Probe::kPhDefault, Probe::kEcDefault, 0, 0, 0};
+				const Result result = runScenario(settings);
+				// Фаза насоса считается от эпохи в EEPROM, поэтому перезагрузка не должна сдвигать циклы
+				const Result rebooted = runScenario(settings, kRebootTime);
+				const uint32_t difference = rebooted.pumpSeconds > result.pumpSeconds
+					? rebooted.pumpSeconds - result.pumpSeconds : result.pumpSeconds - rebooted.pumpSeconds;
+				const bool mismatch = difference > kFillSeconds || rebooted.locked != result.locked;
+				// Камера заполняется быстрее допустимого времени залива, блокировки быть не должно
+				const bool failed = mismatch || result.locked || !result.pumpStarts;
+
+				printf("%-6s flood %2u drain %2u: pump %5u s, starts %4u%s%s%s\n",
+					type == HydroTypes::NORMAL ? "NORMAL" : "SWING", flood, drain, result.pumpSeconds,
+					result.pumpStarts, result.locked ? ", LOCKED" : "", mismatch ? ", CHANGED BY REBOOT" : "",
+					failed ? ", FAILED" : "");
+
+				++scenarios;
+				loops += result.loops + rebooted.loops;
+				locks += result.locked ? 1 : 0;
+				rebootMismatches += mismatch ? 1 : 0;
+				failures += failed ? 1 : 0;
+			}
+		}
+	}
+
+	// Протечка в режиме NORMAL: камера не заполняется за maxTimeForFullFlood, насос блокируется
+	// до сброса с экрана, в том числе после перезагрузки
+	const EepromData leak{15, 10, {7, 0}, {23, 30}, 10, HydroTypes::NORMAL, 120, {}, 0, 0, PumpPhase::kNoEpoch,
+		Probe::kPhDefault, Probe::kEcDefault, 0, 0, 0};
+	const Result leaked = runScenario(leak, kRebootTime, kLeakFillSeconds);
+	const bool leakFailed = !leaked.locked || leaked.pumpAfterLock;
+	printf("leak: %s at %u s, pump after lock %u ms%s\n", leaked.locked ? "locked" : "NOT LOCKED", leaked.lockedAt,
+		leaked.pumpAfterLock, leakFailed ? ", FAILED" : "");
+	failures += leakFailed ? 1 : 0;
+
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%u scenarios, %u locked, %u changed by reboot, %u failed, %.2f s (%.1f scenarios/s, %.0f loops each)\n",
+		scenarios, locks, rebootMismatches, failures, elapsed, scenarios / elapsed,
+		static_cast<double>(loops) / (2 * scenarios));
+
+	return failures || checkFailures ? 1 : 0;
+}
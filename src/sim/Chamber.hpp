@@ -0,0 +1,141 @@
+//
+// Chamber.hpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Модель камеры затопления: насос наливает с постоянным расходом, слив идет через отверстие в дне
+// (расход пропорционален корню из уровня), поплавок срабатывает на заданном объеме с гистерезисом.
+// Излишек сверх объема камеры уходит обратно в бак через перелив. Уровень считается по точному решению
+// уравнения, поэтому шаг может быть любым, а untilChange() дает момент переключения поплавка
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+class Chamber {
+public:
+	struct Params {
+		float volume;      // Объем камеры, мл
+		float floatLevel;  // Объем, при котором срабатывает поплавок, мл
+		float hysteresis;  // Гистерезис поплавка, мл
+		float pumpFlow;    // Производительность насоса, мл/с
+		float drainFlow;   // Расход слива при полной камере, мл/с
+	};
+
+	static constexpr uint32_t kNever{UINT32_MAX};
+
+	explicit Chamber(const Params &aParams) :
+	_params(aParams),
+	_drain{aParams.volume > 0 ? aParams.drainFlow / sqrt(aParams.volume) : 0},
+	_level{0},
+	_float{false}
+	{
+
+	}
+
+	void step(bool aPump, uint32_t aMilliseconds)
+	{
+		const double dt = aMilliseconds / 1000.0;
+
+		if (!aPump) {
+			// Без насоса корень из уровня убывает линейно
+			const double root = sqrt(_level) - _drain * dt / 2;
+			_level = root > 0 ? root * root : 0;
+		} else if (_level < limit()) {
+			if (fillTime(limit()) <= dt) {
+				_level = limit();
+			} else {
+				// Уровень, до которого камера наливается за dt: время налива растет с уровнем, ищем делением пополам
+				double low = _level;
+				double high = limit();
+				for (uint8_t i = 0; i < kBisections; ++i) {
+					const double middle = (low + high) / 2;
+					(fillTime(middle) <= dt ? low : high) = middle;
+				}
+				_level = low;
+			}
+		}
+
+		if (_level >= _params.floatLevel) {
+			_float = true;
+		} else if (_level < _params.floatLevel - _params.hysteresis) {
+			_float = false;
+		}
+	}
+
+	// Миллисекунд до переключения поплавка, если насос не переключится, kNever - не переключится
+	uint32_t untilChange(bool aPump) const
+	{
+		double seconds;
+
+		if (!_float) {
+			if (!aPump || _params.floatLevel > limit()) {
+				return kNever;
+			}
+			seconds = fillTime(_params.floatLevel);
+		} else {
+			const double low = _params.floatLevel - _params.hysteresis;
+			if (aPump || low <= 0 || _drain <= 0) {
+				return kNever;
+			}
+			seconds = 2 * (sqrt(_level) - sqrt(low)) / _drain;
+		}
+
+		const double milliseconds = ceil(seconds * 1000);
+		return milliseconds <= 0 ? 0 : (milliseconds >= kNever ? kNever : static_cast<uint32_t>(milliseconds));
+	}
+
+	// Уровень на пине поплавка: высокий - камера заполнена
+	bool floatSwitch() const
+	{
+		return _float;
+	}
+
+	float level() const
+	{
+		return static_cast<float>(_level);
+	}
+
+private:
+	static constexpr uint8_t kBisections{48};
+
+	// Наибольший уровень при работающем насосе: равновесие налива и слива или объем камеры
+	double limit() const
+	{
+		if (_drain <= 0) {
+			return _params.pumpFlow > 0 ? _params.volume : _level;
+		}
+		const double balance = _params.pumpFlow / _drain;
+		return balance * balance < _params.volume ? balance * balance : _params.volume;
+	}
+
+	// Секунды налива от текущего уровня до aLevel. С заменой u = sqrt(level) уравнение
+	// dlevel/dt = pump - drain * u дает
+	// t = 2 / drain * (u0 - u) + 2 * pump / drain^2 * ln((pump - drain * u0) / (pump - drain * u))
+	double fillTime(double aLevel) const
+	{
+		const double pump = _params.pumpFlow;
+
+		if (aLevel <= _level) {
+			return 0;
+		} else if (_drain <= 0) {
+			return pump > 0 ? (aLevel - _level) / pump : INFINITY;
+		}
+
+		const double from = sqrt(_level);
+		const double to = sqrt(aLevel);
+		if (pump - _drain * to <= 0) {
+			return INFINITY;
+		}
+		return 2 / _drain * (from - to)
+			+ 2 * pump / (_drain * _drain) * log((pump - _drain * from) / (pump - _drain * to));
+	}
+
+	Params _params;
+	double _drain; // Расход слива на корень из уровня
+	double _level;
+	bool _float;
+};
@@ -0,0 +1,291 @@
+//
+// main.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Симулятор сезона в ускоренном времени: ядро крутится на фейковом железе, камера затопления
+// моделируется Chamber, поплавок подается на kFloatLevelPin. Часы переводятся сразу к ближайшему
+// событию, как в хостовом прогоне: сроку задач выходов ядра, окончанию выдержки поплавка или
+// переключению поплавка в модели камеры, поэтому времена поплавка и насоса точны до миллисекунды.
+// Параметры задаются как ключ=значение, например: program days=120 mode=swing flood=15 drain=10.
+// telemetry=<путь> - кадры телеметрии в файл или pty (tools/telemetry)
+
+#include "Board.hpp"
+#include "Chamber.hpp"
+#include "Core.hpp"
+#include "FakeBoard.hpp"
+#include "Hal.hpp"
+#include "LogEvents.hpp"
+#include "PumpPhase.hpp"
+#include "Settings.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <initializer_list>
+#include <unistd.h>
+
+namespace {
+
+static constexpr uint32_t kStartTime{1640995200}; // 01.01.2022 00:00:00
+
+struct Options {
+	uint32_t days{120};
+	int mode{-1}; // -1 - оба режима
+	EepromData settings{15, 10, {7, 0}, {23, 30}, 10, HydroTypes::NORMAL, 240, {}, 0, 0, PumpPhase::kNoEpoch,
+		Probe::kPhDefault, Probe::kEcDefault, 0, 0, 0};
+	Chamber::Params chamber{3000, 2700, 100, 25, 8};
+	bool verbose{false};
+	const char *telemetry{nullptr};
+};
+
+struct Report {
+	uint64_t pumpMs{0};
+	uint32_t floodPhases{0};
+	uint32_t pumpStarts{0};
+	uint32_t swingStarts{0}; // По событиям ядра, а не по выходу насоса
+	uint32_t swingSkips{0}; // Интервалы, после которых камера была еще полна
+	uint32_t floatTrips{0};
+	uint32_t floatTimeouts{0}; // Насос остановлен без срабатывания поплавка
+	uint32_t tripMinMs{UINT32_MAX};
+	uint32_t tripMaxMs{0};
+	uint64_t tripSumMs{0};
+	uint32_t overrunMaxMs{0}; // Насос работает после срабатывания поплавка
+	uint64_t overrunSumMs{0};
+	bool locked{false}; // Насос заблокирован критической ошибкой
+	uint64_t lockedAtMs{0};
+	uint64_t loops{0}; // Проходов ядра
+};
+
+uint64_t earliest(uint64_t aFirst, uint64_t aSecond)
+{
+	return aFirst < aSecond ? aFirst : aSecond;
+}
+
+void printTime(uint64_t aMs)
+{
+	const uint64_t seconds = aMs / 1000;
+	printf("%llud %02llu:%02llu:%02llu", static_cast<unsigned long long>(seconds / 86400),
+		static_cast<unsigned long long>(seconds / 3600 % 24), static_cast<unsigned long long>(seconds / 60 % 60),
+		static_cast<unsigned long long>(seconds % 60));
+}
+
+Report simulate(const Options &aOptions, HydroTypes aType)
+{
+	Report report;
+	Chamber chamber{aOptions.chamber};
+	EepromData settings = aOptions.settings;
+	settings.hydroType = aType;
+
+	FakeBoard::reset(kStartTime);
+	SettingsStore{}.save(settings, kSettingsVersion);
+	FakeBoard::setInput(kFloatLevelPin, false);
+
+	const uint64_t duration = static_cast<uint64_t>(aOptions.days) * 86400 * 1000;
+	uint64_t now{0};
+	uint64_t pumpStartedAt{0};
+	uint64_t tripAt{0};
+	bool overrun{false};
+	bool lastPump{false};
+	bool lastFlood{false};
+	bool lastFloat{false};
+
+	coreSetup();
+
+	while (now < duration) {
+		const int32_t wait = static_cast<int32_t>(coreNextDeadline() - Hal::millis());
+		uint64_t step = wait > 0 ? static_cast<uint64_t>(wait) : 0;
+
+		step = earliest(step, FakeBoard::pendingTime());
+		step = earliest(step, chamber.untilChange(lastPump));
+		step = earliest(step, duration - now);
+		step = step ? step : 1;
+
+		// Насос весь шаг в том состоянии, в котором его оставил прошлый проход ядра
+		FakeBoard::advance(static_cast<uint32_t>(step));
+		chamber.step(lastPump, static_cast<uint32_t>(step));
+		now += step;
+		if (lastPump) {
+			report.pumpMs += step;
+		}
+
+		const bool level = chamber.floatSwitch();
+		FakeBoard::setInput(kFloatLevelPin, level);
+		if (level && !lastFloat && lastPump) {
+			const uint32_t trip = static_cast<uint32_t>(now - pumpStartedAt);
+			++report.floatTrips;
+			tripAt = now;
+			overrun = aType == HydroTypes::SWING;
+			report.tripSumMs += trip;
+			report.tripMinMs = trip < report.tripMinMs ? trip : report.tripMinMs;
+			report.tripMaxMs = trip > report.tripMaxMs ? trip : report.tripMaxMs;
+
+			if (aOptions.verbose) {
+				printTime(now);
+				printf(" float trip after %.3f s\n", trip / 1000.0);
+			}
+		}
+
+		coreLoop();
+		++report.loops;
+
+		const bool pump = FakeBoard::output(kPumpPin);
+		const bool flood = FakeBoard::output(kBlueLedPin);
+
+		if (flood && !lastFlood) {
+			++report.floodPhases;
+		}
+
+		if (overrun && !pump) {
+			const uint32_t overrunMs = static_cast<uint32_t>(now - tripAt);
+			report.overrunSumMs += overrunMs;
+			report.overrunMaxMs = overrunMs > report.overrunMaxMs ? overrunMs : report.overrunMaxMs;
+			overrun = false;
+		}
+
+		if (pump && !lastPump) {
+			++report.pumpStarts;
+			pumpStartedAt = now;
+		} else if (!pump && lastPump && !level) {
+			++report.floatTimeouts;
+		}
+
+		if (!report.locked && FakeBoard::eventCount(LogEvents::PUMP_LOCKED)) {
+			report.locked = true;
+			report.lockedAtMs = now;
+		}
+
+		lastPump = pump;
+		lastFlood = flood;
+		lastFloat = level;
+	}
+
+	report.swingStarts = FakeBoard::eventCount(LogEvents::SWING_ON);
+	report.swingSkips = FakeBoard::eventCount(LogEvents::SWING_SKIP);
+	return report;
+}
+
+void printReport(HydroTypes aType, const Options &aOptions, const Report &aReport)
+{
+	printf("%s, %u days\n", aType == HydroTypes::NORMAL ? "NORMAL" : "SWING", aOptions.days);
+	printf("  pump run time   %.1f h\n", aReport.pumpMs / 3600000.0);
+	printf("  flood phases    %u\n", aReport.floodPhases);
+	printf("  pump starts     %u\n", aReport.pumpStarts);
+
+	if (aType == HydroTypes::SWING) {
+		printf("  swing starts    %u, skipped %u (chamber still full)\n", aReport.swingStarts, aReport.swingSkips);
+	}
+
+	if (aReport.floatTrips) {
+		printf("  float trips     %u, time to trip min %.3f / avg %.3f / max %.3f s\n", aReport.floatTrips,
+			aReport.tripMinMs / 1000.0, aReport.tripSumMs / 1000.0 / aReport.floatTrips, aReport.tripMaxMs / 1000.0);
+	} else {
+		printf("  float trips     0\n");
+	}
+
+	printf("  float timeouts  %u\n", aReport.floatTimeouts);
+
+	if (aType == HydroTypes::SWING && aReport.floatTrips) {
+		printf("  pump after trip avg %.3f / max %.3f s\n", aReport.overrunSumMs / 1000.0 / aReport.floatTrips,
+			aReport.overrunMaxMs / 1000.0);
+	}
+
+	if (aReport.locked) {
+		printf("  LOCKED at ");
+		printTime(aReport.lockedAtMs);
+		printf("\n");
+	}
+}
+
+bool parseOption(Options &aOptions, const char *aArg)
+{
+	const char *value = strchr(aArg, '=');
+	if (!strcmp(aArg, "-v")) {
+		aOptions.verbose = true;
+		return true;
+	} else if (value == nullptr) {
+		return false;
+	}
+
+	const size_t keyLength = static_cast<size_t>(value - aArg);
+	++value;
+
+	auto is = [&](const char *aKey) { return strlen(aKey) == keyLength && !strncmp(aArg, aKey, keyLength); };
+
+	if (is("days")) {
+		aOptions.days = strtoul(value, nullptr, 10);
+	} else if (is("mode")) {
+		aOptions.mode = !strcmp(value, "normal") ? static_cast<int>(HydroTypes::NORMAL) : static_cast<int>(HydroTypes::SWING);
+	} else if (is("flood")) {
+		aOptions.settings.pumpOnPeriod = atoi(value);
+	} else if (is("drain")) {
+		aOptions.settings.pumpOffPeriod = atoi(value);
+	} else if (is("swing")) {
+		aOptions.settings.swingOffPeriod = atoi(value);
+	} else if (is("maxflood")) {
+		aOptions.settings.maxTimeForFullFlood = atoi(value);
+	} else if (is("volume")) {
+		aOptions.chamber.volume = atof(value);
+	} else if (is("floatlevel")) {
+		aOptions.chamber.floatLevel = atof(value);
+	} else if (is("hysteresis")) {
+		aOptions.chamber.hysteresis = atof(value);
+	} else if (is("pumpflow")) {
+		aOptions.chamber.pumpFlow = atof(value);
+	} else if (is("drainflow")) {
+		aOptions.chamber.drainFlow = atof(value);
+	} else if (is("telemetry")) {
+		aOptions.telemetry = value;
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!parseOption(options, argv[i])) {
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			fprintf(stderr, "Options: days mode=normal|swing flood drain swing maxflood volume floatlevel hysteresis"
+				" pumpflow drainflow telemetry -v\n");
+			return 1;
+		}
+	}
+
+	int telemetry{-1};
+	if (options.telemetry) {
+		telemetry = open(options.telemetry, O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY, 0644);
+		if (telemetry < 0) {
+			fprintf(stderr, "Unable to open %s\n", options.telemetry);
+			return 1;
+		}
+		FakeBoard::setTelemetryOutput(telemetry);
+	}
+
+	for (auto type : {HydroTypes::NORMAL, HydroTypes::SWING}) {
+		if (options.mode >= 0 && options.mode != static_cast<int>(type)) {
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const Report report = simulate(options, type);
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		printReport(type, options, report);
+		printf("  simulated in %.2f s, %llu core passes\n", elapsed, static_cast<unsigned long long>(report.loops));
+	}
+
+	if (telemetry >= 0) {
+		close(telemetry);
+	}
+	return 0;
+}
@@ -0,0 +1,276 @@
+//
+// Decoder.cpp
+//
+//  Created on: Oct 16, 2026
+//      Author: V.Nezlo
+//
+
+// Декодер телеметрии для Linux: читает кадры Telemetry.hpp из последовательного порта и печатает
+// по строке на кадр с временем хоста. Испорченные кадры и пропуски номеров считаются, по
+// завершении счетчики печатаются в stderr. Кадр с номером 0 не по порядку - перезапуск контроллера.
+// Запуск: decoder /dev/ttyUSB0 [скорость] или decoder --pty - создает pty и печатает путь к
+// его подчиненной стороне, туда можно направить хостовую сборку (simulator telemetry=<путь>)
+
+#include "LogEvents.hpp"
+#include "Telemetry.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+struct Counters {
+	uint32_t frames;
+	uint32_t bad; // Ошибка COBS или CRC, кадр длиннее допустимого
+	uint32_t lost; // Пропущенные номера
+};
+
+Counters counters{0, 0, 0};
+bool sequenceKnown{false};
+uint8_t lastSequence{0};
+
+speed_t baudRate(unsigned long aRate)
+{
+	switch (aRate) {
+		case 9600:
+			return B9600;
+		case 19200:
+			return B19200;
+		case 38400:
+			return B38400;
+		case 57600:
+			return B57600;
+		case 115200:
+			return B115200;
+		case 230400:
+			return B230400;
+		default:
+			return 0;
+	}
+}
+
+bool setRaw(int aFd, speed_t aSpeed)
+{
+	struct termios tty;
+	if (tcgetattr(aFd, &tty)) {
+		return false;
+	}
+
+	cfmakeraw(&tty);
+	tty.c_cflag |= CLOCAL | CREAD;
+	tty.c_cc[VMIN] = 1;
+	tty.c_cc[VTIME] = 0;
+	if (aSpeed) {
+		cfsetispeed(&tty, aSpeed);
+		cfsetospeed(&tty, aSpeed);
+	}
+	return !tcsetattr(aFd, TCSANOW, &tty);
+}
+
+int openPty()
+{
+	const int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) || unlockpt(master)) {
+		return -1;
+	}
+
+	// Пока подчиненная сторона закрыта, ее режим сбрасывается, поэтому raw ставится через master
+	setRaw(master, 0);
+	fprintf(stderr, "pty %s\n", ptsname(master));
+	return master;
+}
+
+void printStamp()
+{
+	struct timeval now;
+	gettimeofday(&now, nullptr);
+	struct tm fields;
+	localtime_r(&now.tv_sec, &fields);
+
+	char text[32];
+	strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &fields);
+	printf("%s.%03ld ", text, static_cast<long>(now.tv_usec / 1000));
+}
+
+void printSnapshot(const Telemetry::Snapshot &aSnapshot)
+{
+	printf("snapshot uptime=%u unix=%u flood=%u pump=%u swing=%u lamp=%u level=%u float=%u error=%u setup=%u"
+		" mode=%u trips=%u errors=%u successed=%u loops=%u loopmax=%u dropped=%u",
+		aSnapshot.uptime, aSnapshot.unixTime,
+		!!(aSnapshot.flags & Telemetry::kFlagFloodPhase), !!(aSnapshot.flags & Telemetry::kFlagPump),
+		!!(aSnapshot.flags & Telemetry::kFlagSwing), !!(aSnapshot.flags & Telemetry::kFlagLamp),
+		aSnapshot.lampLevel, !!(aSnapshot.flags & Telemetry::kFlagFloat), !!(aSnapshot.flags & Telemetry::kFlagError),
+		!!(aSnapshot.flags & Telemetry::kFlagSetup), aSnapshot.hydroType, aSnapshot.floodTrips, aSnapshot.errors,
+		aSnapshot.successed, aSnapshot.loops, aSnapshot.loopMax, aSnapshot.dropped);
+	printf(" ph=%u.%02u ec=%u", aSnapshot.ph / 100, aSnapshot.ph % 100, aSnapshot.ec);
+	if (aSnapshot.temperature != INT16_MIN) {
+		printf(" temp=%.1f", aSnapshot.temperature / 10.0);
+	} else {
+		printf(" temp=-");
+	}
+	printf(" stack=%u frag=%u locked=%u", aSnapshot.stackFree, aSnapshot.heapFree,
+		!!(aSnapshot.flags & Telemetry::kFlagLocked));
+}
+
+void printEvent(const Telemetry::Event &aEvent)
+{
+	printf("event unix=%u ", aEvent.time);
+	if (aEvent.type < static_cast<uint8_t>(LogEvents::COUNT)) {
+		printf("\"%s\"", kLogEventNames[aEvent.type]);
+	} else {
+		printf("type=%u", aEvent.type);
+	}
+	printf(" arg=%u", aEvent.argument);
+}
+
+void printText(const uint8_t *aText, size_t aSize)
+{
+	printf("text \"");
+	for (size_t i = 0; i < aSize; ++i) {
+		if (aText[i] == '"' || aText[i] == '\\') {
+			printf("\\%c", aText[i]);
+		} else if (aText[i] < 0x20 || aText[i] >= 0x7F) {
+			printf("\\x%02X", aText[i]);
+		} else {
+			putchar(aText[i]);
+		}
+	}
+	putchar('"');
+}
+
+void handleFrame(const uint8_t *aData, size_t aSize)
+{
+	uint8_t buffer[Telemetry::kMaxFrameSize];
+	Telemetry::Frame frame;
+
+	if (!Telemetry::parse(aData, aSize, buffer, frame)) {
+		++counters.bad;
+		printStamp();
+		printf("bad frame, %zu bytes\n", aSize);
+		return;
+	}
+
+	++counters.frames;
+	if (sequenceKnown && !frame.sequence && lastSequence != UINT8_MAX) {
+		// Контроллер перезапустился, нумерация началась заново
+		printStamp();
+		printf("restart\n");
+	} else if (sequenceKnown && frame.sequence != static_cast<uint8_t>(lastSequence + 1)) {
+		const uint8_t lost = frame.sequence - lastSequence - 1;
+		counters.lost += lost;
+		printStamp();
+		printf("lost %u\n", lost);
+	}
+	sequenceKnown = true;
+	lastSequence = frame.sequence;
+
+	printStamp();
+	printf("#%03u ", frame.sequence);
+
+	Telemetry::Snapshot snapshot;
+	Telemetry::Event event;
+	switch (frame.type) {
+		case Telemetry::Type::TEXT:
+			printText(frame.payload, frame.size);
+			break;
+		case Telemetry::Type::SNAPSHOT:
+			if (Telemetry::unpack(frame.payload, frame.size, snapshot)) {
+				printSnapshot(snapshot);
+			} else {
+				printf("short snapshot, %zu bytes", frame.size);
+			}
+			break;
+		case Telemetry::Type::EVENT:
+			if (Telemetry::unpack(frame.payload, frame.size, event)) {
+				printEvent(event);
+			} else {
+				printf("short event, %zu bytes", frame.size);
+			}
+			break;
+		default:
+			printf("unknown type %u, %zu bytes", static_cast<unsigned>(frame.type), frame.size);
+			break;
+	}
+	putchar('\n');
+	fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <tty> [baud] | --pty\n", argv[0]);
+		return 1;
+	}
+
+	const bool pty = !strcmp(argv[1], "--pty");
+	int fd;
+
+	if (pty) {
+		fd = openPty();
+	} else {
+		const speed_t speed = baudRate(argc > 2 ? strtoul(argv[2], nullptr, 10) : 115200);
+		if (!speed) {
+			fprintf(stderr, "Unsupported baud rate %s\n", argv[2]);
+			return 1;
+		}
+
+		fd = open(argv[1], O_RDONLY | O_NOCTTY);
+		if (fd >= 0 && isatty(fd) && !setRaw(fd, speed)) {
+			fprintf(stderr, "Unable to configure %s: %s\n", argv[1], strerror(errno));
+			return 1;
+		}
+	}
+
+	if (fd < 0) {
+		fprintf(stderr, "Unable to open %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	uint8_t frame[Telemetry::kMaxFrameSize];
+	size_t size{0};
+	bool overflow{false}; // Разделитель потерян, байты до следующего отбрасываются
+	bool received{false};
+
+	while (true) {
+		uint8_t chunk[256];
+		const ssize_t count = read(fd, chunk, sizeof(chunk));
+
+		if (count < 0 && errno == EINTR) {
+			continue;
+		} else if (count < 0 && errno == EIO && pty && !received) {
+			usleep(10000); // Подчиненную сторону pty еще никто не открыл
+			continue;
+		} else if (count <= 0) {
+			break; // Конец файла, порт отключен или pty закрыт писателем
+		}
+		received = true;
+
+		for (ssize_t i = 0; i < count; ++i) {
+			if (chunk[i] == Cobs::kDelimiter) {
+				if (overflow) {
+					++counters.bad;
+				} else if (size) {
+					handleFrame(frame, size);
+				}
+				size = 0;
+				overflow = false;
+			} else if (size < sizeof(frame)) {
+				frame[size++] = chunk[i];
+			} else {
+				overflow = true;
+			}
+		}
+	}
+
+	fprintf(stderr, "frames %u, bad %u, lost %u\n", counters.frames, counters.bad, counters.lost);
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Проверка декодера телеметрии через pty: симулятор пишет кадры в pty, декодер их разбирает.
+# Собирает симулятор (env:simulator) и декодер, в конце печатает счетчики декодера.
+# Проверка проходит, если нет испорченных и потерянных кадров
+# Зависимости: platformio
+# Использование: tools/telemetry/run-pty.sh [дней симуляции]
+
+set -e
+cd "$(dirname "$0")/../.."
+
+DAYS=${1:-2}
+OUT=.pio/build/telemetry
+mkdir -p $OUT
+
+pio run -e simulator
+c++ -std=gnu++14 -O2 -I include tools/telemetry/Decoder.cpp -o $OUT/decoder
+
+$OUT/decoder --pty > $OUT/frames.txt 2> $OUT/decoder.txt &
+DECODER=$!
+
+PTY=""
+while [ -z "$PTY" ]; do
+	sleep 0.1
+	PTY=$(sed -n 's/^pty //p' $OUT/decoder.txt)
+done
+
+.pio/build/simulator/program days=$DAYS telemetry=$PTY > /dev/null
+wait $DECODER
+
+tail -n 1 $OUT/decoder.txt
+grep -q "bad 0, lost 0" $OUT/decoder.txt